@@ -0,0 +1,419 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+  #include <unistd.h>
+#endif
+
+#include <MK/Core.hpp>
+#include <MK/Graphics.hpp>
+
+// Default Settings
+constexpr int   DEFAULT_COUNT   {5000};
+constexpr int   DEFAULT_FRAMES  {300};
+constexpr int   DEFAULT_WARMUP  {30};
+constexpr int   DEFAULT_WIDTH   {1280};
+constexpr int   DEFAULT_HEIGHT  {720};
+constexpr float STEP            {1.f / 60.f};
+constexpr float MAX_SPEED       {120.f};
+constexpr float MAX_SPIN        {90.f};
+
+/**
+ * @brief The settings of a benchmark run, read from the command line.
+ */
+struct Settings
+{
+  std::string  scene     {"static"};
+  std::string  path      {"immediate"};
+  std::string  format    {"csv"};
+  std::string  output;
+  std::string  resources {"resources"};
+  int          count     {DEFAULT_COUNT};
+  int          frames    {DEFAULT_FRAMES};
+  int          warmup    {DEFAULT_WARMUP};
+  int          width     {DEFAULT_WIDTH};
+  int          height    {DEFAULT_HEIGHT};
+  unsigned int seed      {42u};
+  bool         headless  {true};
+};
+
+/**
+ * @brief A rectangle of the scene and its motion.
+ */
+struct Body
+{
+  mk::Space::Vec2 velocity;
+  float           spin;
+  int             group;  ///< The renderer drawing the body in the mixed scene.
+};
+
+/**
+ * @brief The measurements of a benchmark run.
+ */
+struct Result
+{
+  double        mean            {0.0};
+  double        p50             {0.0};
+  double        p90             {0.0};
+  double        p99             {0.0};
+  double        max             {0.0};
+  double        gpu             {0.0};
+  double        drawCalls       {0.0};
+  double        triangles       {0.0};
+  double        programSwitches {0.0};
+  double        uploadedBytes   {0.0};
+  double        pairs           {0.0};
+  std::uint64_t residentKB      {0u};
+  std::uint64_t peakResidentKB  {0u};
+};
+
+void printUsage()
+{
+  std::printf(
+    "Usage: mk_bench [options]\n"
+    "  --scene NAME      static, moving, colliders or mixed (default static)\n"
+    "  --path NAME       immediate, instanced or batch rendering, ignored by mixed (default immediate)\n"
+    "  --count N         number of rectangles (default %d)\n"
+    "  --frames N        number of measured frames (default %d)\n"
+    "  --warmup N        number of frames run before measuring (default %d)\n"
+    "  --size W H        framebuffer size (default %dx%d)\n"
+    "  --seed N          seed of the scene layout (default 42)\n"
+    "  --windowed        render to a visible window instead of offscreen\n"
+    "  --format NAME     csv or json (default csv)\n"
+    "  --output FILE     file receiving the results, appended to for csv (default stdout)\n"
+    "  --resources DIR   directory holding the Shaders folder (default resources)\n",
+    DEFAULT_COUNT, DEFAULT_FRAMES, DEFAULT_WARMUP, DEFAULT_WIDTH, DEFAULT_HEIGHT
+  );
+}
+
+bool parseSettings(const int argc, char** argv, Settings& settings)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument {argv[i]};
+    const bool hasValue = i + 1 < argc;
+    if (argument == "--scene" && hasValue)
+      settings.scene = argv[++i];
+    else if (argument == "--path" && hasValue)
+      settings.path = argv[++i];
+    else if (argument == "--count" && hasValue)
+      settings.count = std::atoi(argv[++i]);
+    else if (argument == "--frames" && hasValue)
+      settings.frames = std::atoi(argv[++i]);
+    else if (argument == "--warmup" && hasValue)
+      settings.warmup = std::atoi(argv[++i]);
+    else if (argument == "--size" && i + 2 < argc)
+    {
+      settings.width = std::atoi(argv[++i]);
+      settings.height = std::atoi(argv[++i]);
+    }
+    else if (argument == "--seed" && hasValue)
+      settings.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+    else if (argument == "--windowed")
+      settings.headless = false;
+    else if (argument == "--format" && hasValue)
+      settings.format = argv[++i];
+    else if (argument == "--output" && hasValue)
+      settings.output = argv[++i];
+    else if (argument == "--resources" && hasValue)
+      settings.resources = argv[++i];
+    else
+    {
+      std::fprintf(stderr, "Unknown or incomplete option (%s)!\n", argument.c_str());
+      return false;
+    }
+  }
+
+  const bool validScene = settings.scene == "static" || settings.scene == "moving" || settings.scene == "colliders" || settings.scene == "mixed";
+  const bool validPath = settings.path == "immediate" || settings.path == "instanced" || settings.path == "batch";
+  const bool validFormat = settings.format == "csv" || settings.format == "json";
+  if (!validScene || !validPath || !validFormat || settings.count < 0 || settings.frames <= 0 || settings.warmup < 0 || settings.width <= 0 || settings.height <= 0)
+  {
+    std::fprintf(stderr, "Invalid settings!\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the resident set size of the process.
+ * @return The resident memory in kilobytes, or zero where /proc is unavailable.
+ */
+std::uint64_t residentKilobytes()
+{
+#if defined(__linux__)
+  std::FILE* file = std::fopen("/proc/self/statm", "r");
+  if (file == nullptr)
+    return 0u;
+  unsigned long long size {0u};
+  unsigned long long resident {0u};
+  const int read = std::fscanf(file, "%llu %llu", &size, &resident);
+  std::fclose(file);
+  if (read != 2)
+    return 0u;
+  return static_cast<std::uint64_t>(resident) * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE)) / 1024u;
+#else
+  return 0u;
+#endif
+}
+
+bool writeResult(const Settings& settings, const Result& result)
+{
+  // CSV runs are appended to the output file, with a header only when the file is new
+  std::FILE* file = stdout;
+  bool needsHeader = true;
+  if (!settings.output.empty())
+  {
+    if (settings.format == "csv")
+    {
+      if (std::FILE* existing = std::fopen(settings.output.c_str(), "r"))
+      {
+        needsHeader = std::fgetc(existing) == EOF;
+        std::fclose(existing);
+      }
+    }
+    file = std::fopen(settings.output.c_str(), settings.format == "csv" ? "a" : "w");
+    if (file == nullptr)
+    {
+      std::fprintf(stderr, "Failed to open file (%s)!\n", settings.output.c_str());
+      return false;
+    }
+  }
+
+  const char* mode = settings.headless ? "headless" : "windowed";
+  const char* path = settings.scene == "mixed" ? "mixed" : settings.path.c_str();
+  if (settings.format == "csv")
+  {
+    if (needsHeader)
+      std::fprintf(file, "version,scene,path,mode,count,frames,seed,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,gpu_ms,draw_calls,triangles,program_switches,uploaded_bytes,pairs,resident_kb,peak_resident_kb\n");
+    std::fprintf(
+      file, "%s,%s,%s,%s,%d,%d,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.1f,%.1f,%.1f,%.1f,%llu,%llu\n",
+      mk::Constants::ENGINE_VERSION.c_str(), settings.scene.c_str(), path, mode, settings.count, settings.frames, settings.seed,
+      result.mean, result.p50, result.p90, result.p99, result.max, result.gpu,
+      result.drawCalls, result.triangles, result.programSwitches, result.uploadedBytes, result.pairs,
+      static_cast<unsigned long long>(result.residentKB), static_cast<unsigned long long>(result.peakResidentKB)
+    );
+  }
+  else
+  {
+    std::fprintf(
+      file,
+      "{\n"
+      "  \"version\": \"%s\",\n  \"scene\": \"%s\",\n  \"path\": \"%s\",\n  \"mode\": \"%s\",\n"
+      "  \"count\": %d,\n  \"frames\": %d,\n  \"seed\": %u,\n"
+      "  \"cpu_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n"
+      "  \"gpu_ms\": %.4f,\n"
+      "  \"per_frame\": {\"draw_calls\": %.1f, \"triangles\": %.1f, \"program_switches\": %.1f, \"uploaded_bytes\": %.1f, \"pairs\": %.1f},\n"
+      "  \"memory_kb\": {\"resident\": %llu, \"peak_resident\": %llu}\n"
+      "}\n",
+      mk::Constants::ENGINE_VERSION.c_str(), settings.scene.c_str(), path, mode,
+      settings.count, settings.frames, settings.seed,
+      result.mean, result.p50, result.p90, result.p99, result.max, result.gpu,
+      result.drawCalls, result.triangles, result.programSwitches, result.uploadedBytes, result.pairs,
+      static_cast<unsigned long long>(result.residentKB), static_cast<unsigned long long>(result.peakResidentKB)
+    );
+  }
+  if (file != stdout)
+    std::fclose(file);
+  return true;
+}
+
+bool run(const Settings& settings)
+{
+  // Window
+  mk::Window window
+  {
+    static_cast<unsigned int>(settings.width),
+    static_cast<unsigned int>(settings.height),
+    "MK Bench"
+  };
+  window.setClearColor({24, 24, 24, 1.f});
+  if (!mk::Core::initializeGLEW())
+    return false;
+  if (!settings.headless)
+    glfwSwapInterval(0);
+  window.getGPUProfiler().setEnabled(true);
+
+  // Shaders (the mixed scene draws with two programs of the default shader to force program switches)
+  const std::string shaders = settings.resources + "/Shaders/";
+  mk::Graphics::Shader defaultShader {shaders + "default.vert", shaders + "default.frag"};
+  mk::Graphics::Shader tintShader {shaders + "default.vert", shaders + "default.frag"};
+  mk::Graphics::Shader batchShader {shaders + "batch.vert", shaders + "batch.frag"};
+
+  // Renderers
+  mk::Camera2D camera {window.getBufferDimensions(), -1.f, 1.f};
+  mk::Render::Renderer renderer {defaultShader, camera};
+  mk::Render::Renderer tintRenderer {tintShader, camera};
+  mk::Render::BatchRenderer batchRenderer {batchShader, camera};
+  tintRenderer.setInstanced(true);
+  tintRenderer.setPassName("Tint renderer");
+
+  // Scene
+  const bool isMoving = settings.scene != "static";
+  const bool isMixed = settings.scene == "mixed";
+  renderer.setInstanced(!isMixed && settings.path == "instanced");
+  const float worldWidth = static_cast<float>(settings.width);
+  const float worldHeight = static_cast<float>(settings.height);
+  std::mt19937 generator {settings.seed};
+  std::uniform_real_distribution<float> x {0.f, worldWidth - 24.f};
+  std::uniform_real_distribution<float> y {0.f, worldHeight - 24.f};
+  std::uniform_real_distribution<float> size {4.f, 24.f};
+  std::uniform_real_distribution<float> speed {-MAX_SPEED, MAX_SPEED};
+  std::uniform_real_distribution<float> spin {-MAX_SPIN, MAX_SPIN};
+  std::uniform_int_distribution<int> channel {48, 255};
+
+  std::vector<mk::Shapes::Rectangle> rectangles;
+  std::vector<Body> bodies;
+  rectangles.reserve(settings.count);
+  bodies.reserve(settings.count);
+  for (int i = 0; i < settings.count; i++)
+  {
+    rectangles.emplace_back(mk::Space::Vec2{x(generator), y(generator)}, size(generator), size(generator));
+    const std::uint8_t red = static_cast<std::uint8_t>(channel(generator));
+    const std::uint8_t green = static_cast<std::uint8_t>(channel(generator));
+    const std::uint8_t blue = static_cast<std::uint8_t>(channel(generator));
+    rectangles.back().setFillColor({red, green, blue, 1.f});
+    bodies.push_back({{speed(generator), speed(generator)}, spin(generator), i % 3});
+    if (isMoving)
+      rectangles.back().setRotation(spin(generator) * 4.f);
+  }
+  const std::vector<mk::Shapes::Rectangle> initialRectangles = rectangles;
+
+  mk::Shapes::Collision::SpatialHash hash {32.f};
+  std::vector<mk::Shapes::Collision::Pair> pairs;
+
+  // Frames (the simulation always advances by a fixed step, so every run computes the same frames)
+  mk::Core::Clock clock {static_cast<std::size_t>(settings.frames)};
+  Result result;
+  double gpuTime {0.0};
+  int gpuFrames {0};
+  const int totalFrames = settings.warmup + settings.frames;
+  for (int frame = 0; frame < totalFrames && window.isOpen(); frame++)
+  {
+    if (frame == settings.warmup)
+    {
+      clock.reset();
+      window.resetStats();
+    }
+
+    window.update();
+    if (isMoving)
+    {
+      for (std::size_t i = 0; i < rectangles.size(); i++)
+      {
+        mk::Shapes::Rectangle& rectangle = rectangles[i];
+        Body& body = bodies[i];
+        const mk::Space::Vec2 position = rectangle.getPosition();
+        if (position.x < 0.f || position.x > worldWidth - rectangle.getWidth())
+          body.velocity.x = -body.velocity.x;
+        if (position.y < 0.f || position.y > worldHeight - rectangle.getHeight())
+          body.velocity.y = -body.velocity.y;
+        rectangle.move(body.velocity * STEP);
+        rectangle.rotate(body.spin * STEP);
+      }
+    }
+    if (settings.scene == "colliders")
+    {
+      hash.clear();
+      for (mk::Shapes::Rectangle& rectangle : rectangles)
+        hash.insert(rectangle);
+      hash.queryPairs(pairs);
+      for (std::size_t i = 0; i < rectangles.size(); i++)
+        rectangles[i].setFillColor(initialRectangles[i].getFillColor());
+      for (const mk::Shapes::Collision::Pair& pair : pairs)
+        if (mk::Shapes::Collision::OBB(rectangles[pair.proxyOne], rectangles[pair.proxyTwo]))
+          rectangles[pair.proxyOne].setFillColor(mk::Color::Red);
+    }
+
+    window.clear();
+    if (isMixed)
+    {
+      renderer.use();
+      for (std::size_t i = 0; i < rectangles.size(); i++)
+        if (bodies[i].group == 0)
+          renderer.render(rectangles[i]);
+      renderer.flush();
+      tintRenderer.use();
+      for (std::size_t i = 0; i < rectangles.size(); i++)
+        if (bodies[i].group == 1)
+          tintRenderer.render(rectangles[i]);
+      tintRenderer.flush();
+      batchRenderer.use();
+      for (std::size_t i = 0; i < rectangles.size(); i++)
+        if (bodies[i].group == 2)
+          batchRenderer.submit(rectangles[i]);
+      batchRenderer.flush();
+    }
+    else if (settings.path == "batch")
+    {
+      batchRenderer.use();
+      for (const mk::Shapes::Rectangle& rectangle : rectangles)
+        batchRenderer.submit(rectangle);
+      batchRenderer.flush();
+    }
+    else
+    {
+      renderer.use();
+      for (const mk::Shapes::Rectangle& rectangle : rectangles)
+        renderer.render(rectangle);
+      renderer.flush();
+    }
+    window.display();
+    clock.tick();
+
+    // Measurements
+    if (frame < settings.warmup)
+      continue;
+    const mk::Render::Stats& stats = window.getStats();
+    result.drawCalls += static_cast<double>(stats.drawCalls);
+    result.triangles += static_cast<double>(stats.triangles);
+    result.programSwitches += static_cast<double>(stats.programSwitches);
+    result.uploadedBytes += static_cast<double>(stats.uploadedBytes);
+    result.pairs += static_cast<double>(pairs.size());
+    result.peakResidentKB = std::max(result.peakResidentKB, residentKilobytes());
+    if (window.getGPUProfiler().getFrameTimeNanoseconds() > 0)
+    {
+      gpuTime += window.getGPUProfiler().getFrameTime();
+      gpuFrames++;
+    }
+  }
+
+  // Results (the clock measures from the end of a frame to the end of the next one)
+  const double frames = static_cast<double>(std::max<std::uint64_t>(clock.getFrameCount(), 1u));
+  result.mean = clock.getAverageFrameTime() * 1e3;
+  result.p50 = clock.getPercentile(50.0) * 1e3;
+  result.p90 = clock.getPercentile(90.0) * 1e3;
+  result.p99 = clock.getPercentile(99.0) * 1e3;
+  result.max = clock.getPercentile(100.0) * 1e3;
+  result.gpu = gpuFrames > 0 ? gpuTime / gpuFrames * 1e3 : 0.0;
+  result.drawCalls /= frames;
+  result.triangles /= frames;
+  result.programSwitches /= frames;
+  result.uploadedBytes /= frames;
+  result.pairs /= frames;
+  result.residentKB = residentKilobytes();
+  result.peakResidentKB = std::max(result.peakResidentKB, result.residentKB);
+  return writeResult(settings, result);
+}
+
+int main(int argc, char** argv)
+{
+  Settings settings;
+  if (!parseSettings(argc, argv, settings))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  // The GL objects of the run are destroyed before GLFW terminates
+  if (!mk::Core::initializeGLFW(settings.headless))
+    return EXIT_FAILURE;
+  const bool success = run(settings);
+  mk::Core::terminate();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <MK/Core.hpp>
+#include <MK/Graphics.hpp>
+
+// Benchmark Settings
+constexpr std::size_t OBJECT_COUNT     {10000u};
+constexpr int         FRAME_COUNT      {60};
+constexpr int         BRUTE_FRAMES     {3};
+constexpr float       WORLD_SIZE       {4000.f};
+constexpr float       MAX_SPEED        {4.f};
+constexpr int         QUERY_COUNT      {1000};
+constexpr float       TOLERANCE        {1e-4f};
+
+struct Body
+{
+  mk::Shapes::BoundRect bounds;
+  mk::Space::Vec2       velocity;
+};
+
+void step(std::vector<Body>& bodies)
+{
+  for (Body& body : bodies)
+  {
+    body.bounds.x += body.velocity.x;
+    body.bounds.y += body.velocity.y;
+    if (body.bounds.x < 0.f || body.bounds.x + body.bounds.width > WORLD_SIZE)
+      body.velocity.x = -body.velocity.x;
+    if (body.bounds.y < 0.f || body.bounds.y + body.bounds.height > WORLD_SIZE)
+      body.velocity.y = -body.velocity.y;
+  }
+}
+
+/**
+ * @brief A pair of oriented boxes and the contact the narrowphase must find for them.
+ */
+struct ContactCase
+{
+  const char*                     name;
+  mk::Shapes::OrientedBox         boxOne;
+  mk::Shapes::OrientedBox         boxTwo;
+  bool                            isHit;
+  mk::Shapes::Collision::Manifold manifold;  ///< The expected contact, ignored when the boxes do not hit.
+};
+
+mk::Shapes::OrientedBox orientedBox(const mk::Space::Vec2& center, const mk::Space::Vec2& halfExtents, const float degrees)
+{
+  // Same axes as Shape::updateAxes
+  const float cosTheta = std::cos(mk::Space::radians(degrees));
+  const float sinTheta = std::sin(mk::Space::radians(degrees));
+  return {center, halfExtents, {{cosTheta, -sinTheta}, {sinTheta, cosTheta}}};
+}
+
+bool isNear(const mk::Space::Vec2& a, const mk::Space::Vec2& b)
+{
+  return std::abs(a.x - b.x) <= TOLERANCE && std::abs(a.y - b.y) <= TOLERANCE;
+}
+
+bool checkContact(const ContactCase& contact)
+{
+  mk::Shapes::Collision::Manifold manifold;
+  const bool isHit = mk::Shapes::Collision::SAT(contact.boxOne, contact.boxTwo, manifold);
+  const bool isOverlap = mk::Shapes::Collision::OBB(contact.boxOne, contact.boxTwo);
+  if (isHit != contact.isHit || isOverlap != contact.isHit)
+    return false;
+  if (!isHit)
+    return true;
+
+  const mk::Shapes::Collision::Manifold& expected = contact.manifold;
+  if (!isNear(manifold.normal, expected.normal) || std::abs(manifold.depth - expected.depth) > TOLERANCE || manifold.pointCount != expected.pointCount)
+    return false;
+
+  // The contact points may come in either order
+  for (int i = 0; i < expected.pointCount; i++)
+  {
+    bool isFound = false;
+    for (int j = 0; j < manifold.pointCount; j++)
+      isFound = isFound || isNear(manifold.points[j], expected.points[i]);
+    if (!isFound)
+      return false;
+  }
+  return true;
+}
+
+double elapsedMilliseconds(const std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+  // Random Moving Bodies
+  std::mt19937 generator {42u};
+  std::uniform_real_distribution<float> position {0.f, WORLD_SIZE - 32.f};
+  std::uniform_real_distribution<float> size {8.f, 32.f};
+  std::uniform_real_distribution<float> speed {-MAX_SPEED, MAX_SPEED};
+
+  std::vector<Body> bodies;
+  bodies.reserve(OBJECT_COUNT);
+  for (std::size_t i = 0; i < OBJECT_COUNT; i++)
+    bodies.push_back({{position(generator), position(generator), size(generator), size(generator)}, {speed(generator), speed(generator)}});
+  std::vector<Body> initialBodies = bodies;
+
+  // Brute Force (all pairs)
+  std::size_t brutePairs {0};
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < BRUTE_FRAMES; frame++)
+  {
+    step(bodies);
+    brutePairs = 0;
+    for (std::size_t i = 0; i < bodies.size(); i++)
+      for (std::size_t j = i + 1; j < bodies.size(); j++)
+        brutePairs += mk::Shapes::Collision::AABB(bodies[i].bounds, bodies[j].bounds);
+  }
+  const double bruteTime = elapsedMilliseconds(start) / BRUTE_FRAMES;
+
+  // AABB Tree (the first frames match the brute force run, so the pair counts can be compared)
+  bodies = initialBodies;
+  mk::Shapes::Collision::AABBTree tree;
+  std::vector<int> proxies;
+  for (const Body& body : bodies)
+    proxies.push_back(tree.insert(body.bounds));
+
+  std::vector<mk::Shapes::Collision::AABBTree::Pair> pairs;
+  std::size_t treePairs {0};
+  std::size_t reinsertions {0};
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    step(bodies);
+    for (std::size_t i = 0; i < bodies.size(); i++)
+      reinsertions += tree.move(proxies[i], bodies[i].bounds, bodies[i].velocity);
+    tree.queryPairs(pairs);
+    if (frame == BRUTE_FRAMES - 1)
+      treePairs = pairs.size();
+  }
+  const double treeTime = elapsedMilliseconds(start) / FRAME_COUNT;
+
+  // Spatial Hash (rebuilt every frame, with cells as large as the largest body)
+  bodies = initialBodies;
+  mk::Shapes::Collision::SpatialHash hash {32.f};
+  std::size_t hashPairs {0};
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    step(bodies);
+    hash.clear();
+    for (const Body& body : bodies)
+      hash.insert(body.bounds);
+    hash.queryPairs(pairs);
+    if (frame == BRUTE_FRAMES - 1)
+      hashPairs = pairs.size();
+  }
+  const double hashTime = elapsedMilliseconds(start) / FRAME_COUNT;
+
+  // Sweep and Prune (persistent endpoints, reporting pair events)
+  bodies = initialBodies;
+  mk::Shapes::Collision::SweepAndPrune sweep;
+  for (std::size_t i = 0; i < bodies.size(); i++)
+    proxies[i] = sweep.insert(bodies[i].bounds);
+  std::vector<mk::Shapes::Collision::Pair> begun;
+  std::vector<mk::Shapes::Collision::Pair> ended;
+  sweep.update(begun, ended);
+
+  std::size_t sweepPairs {0};
+  std::size_t events {0};
+  std::size_t swaps {0};
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < FRAME_COUNT; frame++)
+  {
+    step(bodies);
+    for (std::size_t i = 0; i < bodies.size(); i++)
+      sweep.move(proxies[i], bodies[i].bounds);
+    sweep.update(begun, ended);
+    events += begun.size() + ended.size();
+    swaps += sweep.getSwapCount();
+    if (frame == BRUTE_FRAMES - 1)
+      sweepPairs = sweep.getPairs().size();
+  }
+  const double sweepTime = elapsedMilliseconds(start) / FRAME_COUNT;
+
+  // Batched AABB Tests (every query against every body, as when picking or filtering candidates)
+  std::vector<float> boundX, boundY, boundWidth, boundHeight;
+  for (const Body& body : bodies)
+  {
+    boundX.push_back(body.bounds.x);
+    boundY.push_back(body.bounds.y);
+    boundWidth.push_back(body.bounds.width);
+    boundHeight.push_back(body.bounds.height);
+  }
+  const mk::Shapes::Collision::BoundArrays boundArrays {boundX.data(), boundY.data(), boundWidth.data(), boundHeight.data(), bodies.size()};
+  std::vector<std::uint8_t> hits((bodies.size() + 7) / 8);
+
+  std::size_t aosHits {0};
+  start = std::chrono::steady_clock::now();
+  for (int query = 0; query < QUERY_COUNT; query++)
+    for (const Body& body : bodies)
+      aosHits += mk::Shapes::Collision::AABB(bodies[query].bounds, body.bounds);
+  const double aosTime = elapsedMilliseconds(start) / QUERY_COUNT;
+
+  std::size_t scalarHits {0};
+  start = std::chrono::steady_clock::now();
+  for (int query = 0; query < QUERY_COUNT; query++)
+    scalarHits += mk::Shapes::Collision::Scalar::AABB(bodies[query].bounds, boundArrays, hits.data());
+  const double scalarTime = elapsedMilliseconds(start) / QUERY_COUNT;
+
+  std::size_t simdHits {0};
+  start = std::chrono::steady_clock::now();
+  for (int query = 0; query < QUERY_COUNT; query++)
+    simdHits += mk::Shapes::Collision::AABB(bodies[query].bounds, boundArrays, hits.data());
+  const double simdTime = elapsedMilliseconds(start) / QUERY_COUNT;
+
+  // Narrowphase Contacts (known answers for unit boxes, the diamonds are the same boxes rotated by 45 degrees)
+  const float diagonal = std::sqrt(2.f);
+  const ContactCase contacts[] =
+  {
+    {"Face-face", orientedBox({0.f, 0.f}, {1.f, 1.f}, 0.f), orientedBox({1.5f, 0.f}, {1.f, 1.f}, 0.f), true, {{1.f, 0.f}, 0.5f, {{0.75f, 1.f}, {0.75f, -1.f}}, 2}},
+    {"Face offset", orientedBox({0.f, 0.f}, {1.f, 1.f}, 0.f), orientedBox({1.5f, 1.5f}, {1.f, 1.f}, 0.f), true, {{1.f, 0.f}, 0.5f, {{0.75f, 0.5f}, {0.75f, 1.f}}, 2}},
+    {"Vertex-face", orientedBox({0.f, 0.f}, {1.f, 1.f}, 0.f), orientedBox({2.3f, 0.f}, {1.f, 1.f}, 45.f), true, {{1.f, 0.f}, diagonal - 1.3f, {{(3.3f - diagonal) / 2.f, 0.f}}, 1}},
+    {"Vertex swap", orientedBox({2.3f, 0.f}, {1.f, 1.f}, 45.f), orientedBox({0.f, 0.f}, {1.f, 1.f}, 0.f), true, {{-1.f, 0.f}, diagonal - 1.3f, {{(3.3f - diagonal) / 2.f, 0.f}}, 1}},
+    {"Rotated hit", orientedBox({0.f, 0.f}, {1.f, 1.f}, 45.f), orientedBox({1.2f, 1.2f}, {1.f, 1.f}, 45.f), true, {{diagonal / 2.f, diagonal / 2.f}, 2.f - 2.4f / diagonal, {{0.6f + diagonal / 2.f, 0.6f - diagonal / 2.f}, {0.6f - diagonal / 2.f, 0.6f + diagonal / 2.f}}, 2}},
+    {"Rotated miss", orientedBox({0.f, 0.f}, {1.f, 1.f}, 45.f), orientedBox({1.6f, 1.6f}, {1.f, 1.f}, 45.f), false, {}},
+    {"Separated", orientedBox({0.f, 0.f}, {1.f, 1.f}, 0.f), orientedBox({2.5f, 0.f}, {1.f, 1.f}, 45.f), false, {}},
+  };
+  int passedContacts {0};
+  for (const ContactCase& contact : contacts)
+  {
+    if (checkContact(contact))
+      passedContacts++;
+    else
+      std::printf("Contact mismatch: %s\n", contact.name);
+  }
+  const int contactCount = static_cast<int>(sizeof(contacts) / sizeof(contacts[0]));
+
+  std::printf("Objects: %zu\n\n", OBJECT_COUNT);
+  std::printf("%-13s %12s %10s\n", "Broadphase", "ms / frame", "Pairs");
+  std::printf("%-13s %12.3f %10zu\n", "Brute force", bruteTime, brutePairs);
+  std::printf("%-13s %12.3f %10zu\n", "AABB tree", treeTime, treePairs);
+  std::printf("%-13s %12.3f %10zu\n", "Spatial hash", hashTime, hashPairs);
+  std::printf("%-13s %12.3f %10zu\n", "Sweep/prune", sweepTime, sweepPairs);
+  std::printf("\nTree height: %d, reinsertions / frame: %.1f\n", tree.getHeight(), static_cast<double>(reinsertions) / FRAME_COUNT);
+  std::printf("Hash cells: %d\n", hash.getCellCount());
+  std::printf("Sweep events / frame: %.1f, endpoint swaps / frame: %.1f\n", static_cast<double>(events) / FRAME_COUNT, static_cast<double>(swaps) / FRAME_COUNT);
+
+  std::printf("\n%-13s %12s %10s\n", "Batched AABB", "us / query", "Hits");
+  std::printf("%-13s %12.3f %10zu\n", "AoS loop", aosTime * 1000.0, aosHits);
+  std::printf("%-13s %12.3f %10zu\n", "SoA scalar", scalarTime * 1000.0, scalarHits);
+  std::printf("%-13s %12.3f %10zu\n", "SoA SIMD", simdTime * 1000.0, simdHits);
+
+  std::printf("\nSAT contacts: %d / %d matched\n", passedContacts, contactCount);
+
+  const bool pairsMatch = brutePairs == treePairs && brutePairs == hashPairs && brutePairs == sweepPairs;
+  const bool hitsMatch = aosHits == scalarHits && aosHits == simdHits;
+  const bool contactsMatch = passedContacts == contactCount;
+  return pairsMatch && hitsMatch && contactsMatch ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,223 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <MK/Core.hpp>
+
+// Benchmark Settings
+constexpr std::size_t MATRIX_COUNT {4096u};
+constexpr int         REPETITIONS  {200};
+
+// Keeps the results observable so the kernels are not optimized away
+volatile float sink {0.f};
+
+template<typename Kernel>
+double measure(Kernel kernel)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int repetition = 0; repetition < REPETITIONS; repetition++)
+    kernel();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / (REPETITIONS * MATRIX_COUNT);
+}
+
+float maxDifference(const std::vector<mk::Space::Mat4>& matsOne, const std::vector<mk::Space::Mat4>& matsTwo)
+{
+  float difference {0.f};
+  for (std::size_t i = 0; i < matsOne.size(); i++)
+    for (int row = 0; row < 4; row++)
+      for (int column = 0; column < 4; column++)
+      {
+        const float scale = std::max(1.f, std::fabs(matsOne[i][row][column]));
+        difference = std::max(difference, std::fabs(matsOne[i][row][column] - matsTwo[i][row][column]) / scale);
+      }
+  return difference;
+}
+
+void report(const std::string& name, const double scalarTime, const double simdTime, const float difference)
+{
+  std::printf(
+    "%-16s %10.2f %10.2f %9.2fx %12.2e\n",
+    name.c_str(),
+    scalarTime,
+    simdTime,
+    scalarTime / simdTime,
+    difference
+  );
+}
+
+int main()
+{
+  // Random Model Matrices
+  std::mt19937 generator {42u};
+  std::uniform_real_distribution<float> distribution {-100.f, 100.f};
+
+  std::vector<mk::Space::Mat4> matsOne(MATRIX_COUNT);
+  std::vector<mk::Space::Mat4> matsTwo(MATRIX_COUNT);
+  std::vector<mk::Space::Vec3> points(MATRIX_COUNT);
+  for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+  {
+    matsOne[i] =
+      mk::Space::scale({1.f}, mk::Space::Vec2{1.f + std::fabs(distribution(generator)), 1.f + std::fabs(distribution(generator))}) *
+      mk::Space::rotate({1.f}, {0.f, 0.f, 1.f}, distribution(generator)) *
+      mk::Space::translate({1.f}, mk::Space::Vec2{distribution(generator), distribution(generator)});
+    matsTwo[i] = mk::Space::rotate({1.f}, {0.f, 0.f, 1.f}, distribution(generator));
+    points[i] = {distribution(generator), distribution(generator), 0.f};
+  }
+
+  std::vector<mk::Space::Mat4> scalarResults(MATRIX_COUNT);
+  std::vector<mk::Space::Mat4> simdResults(MATRIX_COUNT);
+
+  std::printf("SIMD Backend: %s\n\n", mk::Space::getSIMDBackend());
+  std::printf("%-16s %10s %10s %10s %12s\n", "Kernel", "Scalar ns", "SIMD ns", "Speedup", "Max Error");
+
+  // Matrix Multiplication
+  const double scalarMultiply = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      scalarResults[i] = mk::Space::Scalar::multiply(matsOne[i], matsTwo[i]);
+  });
+  const double simdMultiply = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      simdResults[i] = mk::Space::multiply(matsOne[i], matsTwo[i]);
+  });
+  report("multiply", scalarMultiply, simdMultiply, maxDifference(scalarResults, simdResults));
+
+  // Transposition
+  const double scalarTranspose = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      scalarResults[i] = mk::Space::Scalar::transpose(matsOne[i]);
+  });
+  const double simdTranspose = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      simdResults[i] = mk::Space::transpose(matsOne[i]);
+  });
+  report("transpose", scalarTranspose, simdTranspose, maxDifference(scalarResults, simdResults));
+
+  // Inversion
+  const double scalarInverse = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      scalarResults[i] = mk::Space::Scalar::inverse(matsOne[i]);
+  });
+  const double simdInverse = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      simdResults[i] = mk::Space::inverse(matsOne[i]);
+  });
+  report("inverse", scalarInverse, simdInverse, maxDifference(scalarResults, simdResults));
+
+  // Point Transformation
+  float scalarSum {0.f};
+  float simdSum {0.f};
+  const double scalarTransform = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      scalarSum += mk::Space::Scalar::transformPoint(matsOne[i], points[i]).x;
+  });
+  const double simdTransform = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      simdSum += mk::Space::transformPoint(matsOne[i], points[i]).x;
+  });
+  report("transformPoint", scalarTransform, simdTransform, std::fabs(scalarSum - simdSum) / std::max(1.f, std::fabs(scalarSum)));
+
+  // Shape Transform (the model transform of a rectangle built both ways)
+  std::vector<mk::Space::Affine2D> affines(MATRIX_COUNT);
+  const double mat4Transform = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      scalarResults[i] =
+        mk::Space::scale({1.f}, mk::Space::Vec2{points[i].x, points[i].y}) *
+        mk::Space::rotate({1.f}, {0.f, 0.f, 1.f}, points[i].x) *
+        mk::Space::translate({1.f}, mk::Space::Vec2{points[i].y, points[i].x});
+  });
+  const double affineTransform = measure([&]()
+  {
+    for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+      affines[i] = mk::Space::Affine2D::fromTransform({points[i].y, points[i].x}, {points[i].x, points[i].y}, points[i].x);
+  });
+  for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+    simdResults[i] = mk::Space::toMat4(affines[i]);
+
+  std::printf("\n%-16s %10s %10s %10s %12s\n", "Kernel", "Mat4 ns", "Affine ns", "Speedup", "Max Error");
+  report("shapeTransform", mat4Transform, affineTransform, maxDifference(scalarResults, simdResults));
+
+  // Batch Transforms (structure-of-arrays input)
+  std::vector<float> positionsX(MATRIX_COUNT);
+  std::vector<float> positionsY(MATRIX_COUNT);
+  std::vector<float> scalesX(MATRIX_COUNT);
+  std::vector<float> scalesY(MATRIX_COUNT);
+  std::vector<float> rotations(MATRIX_COUNT);
+  for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+  {
+    positionsX[i] = distribution(generator);
+    positionsY[i] = distribution(generator);
+    scalesX[i] = std::fabs(distribution(generator));
+    scalesY[i] = std::fabs(distribution(generator));
+    rotations[i] = distribution(generator) * 1.8f;
+  }
+  const mk::Space::TransformArrays arrays {positionsX.data(), positionsY.data(), scalesX.data(), scalesY.data(), rotations.data(), MATRIX_COUNT};
+
+  std::vector<mk::Space::Affine2D> scalarAffines(MATRIX_COUNT);
+  std::vector<mk::Space::Vec2> scalarCorners(MATRIX_COUNT * 4);
+  std::vector<mk::Space::Vec2> simdCorners(MATRIX_COUNT * 4);
+  const double scalarAffineBatch = measure([&]()
+  { mk::Space::Scalar::computeAffines(arrays, scalarAffines.data()); });
+  const double simdAffineBatch = measure([&]()
+  { mk::Space::computeAffines(arrays, affines.data()); });
+  const double scalarCornerBatch = measure([&]()
+  { mk::Space::Scalar::computeQuadCorners(arrays, scalarCorners.data()); });
+  const double simdCornerBatch = measure([&]()
+  { mk::Space::computeQuadCorners(arrays, simdCorners.data()); });
+
+  float affineError {0.f};
+  for (std::size_t i = 0; i < MATRIX_COUNT; i++)
+    for (int row = 0; row < 2; row++)
+      for (int column = 0; column < 3; column++)
+        affineError = std::max(affineError, std::fabs(scalarAffines[i][row][column] - affines[i][row][column]) / std::max(1.f, std::fabs(scalarAffines[i][row][column])));
+  float cornerError {0.f};
+  for (std::size_t i = 0; i < MATRIX_COUNT * 4; i++)
+    cornerError = std::max(cornerError, std::max(std::fabs(scalarCorners[i].x - simdCorners[i].x), std::fabs(scalarCorners[i].y - simdCorners[i].y)) / std::max(1.f, std::fabs(scalarCorners[i].x)));
+
+  std::printf("\n%-16s %10s %10s %10s %12s\n", "Batch Kernel", "Scalar ns", "SIMD ns", "Speedup", "Max Error");
+  report("affines", scalarAffineBatch, simdAffineBatch, affineError);
+  report("quadCorners", scalarCornerBatch, simdCornerBatch, cornerError);
+
+  // Threaded Batch Transforms (a larger batch, so every thread gets a few chunks of work)
+  const unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<float> largePositions(MATRIX_COUNT * 64);
+  std::vector<float> largeRotations(MATRIX_COUNT * 64);
+  for (std::size_t i = 0; i < largePositions.size(); i++)
+  {
+    largePositions[i] = positionsX[i % MATRIX_COUNT];
+    largeRotations[i] = rotations[i % MATRIX_COUNT];
+  }
+  const mk::Space::TransformArrays largeArrays {largePositions.data(), largePositions.data(), largePositions.data(), largePositions.data(), largeRotations.data(), largePositions.size()};
+  std::vector<mk::Space::Vec2> largeCorners(largePositions.size() * 4);
+
+  const auto timeLarge = [&](const unsigned int threads)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < 10; repetition++)
+      mk::Space::computeQuadCorners(largeArrays, largeCorners.data(), threads);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (10 * largePositions.size());
+  };
+  const double singleThreaded = timeLarge(1u);
+  const double multiThreaded = timeLarge(threadCount);
+  std::printf("\n%-16s %10s %10s %10s\n", "Threads", "1 ns", "N ns", "Speedup");
+  std::printf("%-16u %10.2f %10.2f %9.2fx\n", threadCount, singleThreaded, multiThreaded, singleThreaded / multiThreaded);
+
+  sink = scalarSum + simdSum + scalarResults[0][0][0] + simdResults[0][0][0] + largeCorners[0].x;
+  return EXIT_SUCCESS;
+}
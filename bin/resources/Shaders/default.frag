@@ -1,10 +1,10 @@
 #version 330 core
 
-out vec4 FragColor;
+in vec3 vertexColor;
 
-uniform vec3 fillColor;
+out vec4 FragColor;
 
 void main()
 {
-  FragColor = vec4(fillColor, 1.f);
+  FragColor = vec4(vertexColor, 1.f);
 }
@@ -78,6 +78,9 @@ int main()
   // Fullscreen Logic
   bool fullscreenPressed {false};
 
+  // Fixed Timestep Simulation
+  mk::Core::Loop loop;
+
   // Adding Renderer to the Window
   window.addRenderer(shapeRenderer);
 
@@ -120,7 +123,13 @@ int main()
     if (window.isKeyPressed(mk::Input::Key::D))
       xFactor += 1.f;
 
-    player.move(mk::Space::normalize({xFactor, yFactor}) * window.getDeltaTime() * 300.f);
+    const mk::Space::Vec2 direction = mk::Space::normalize({xFactor, yFactor});
+    loop.runNanoseconds(window.getClock().getDeltaNanoseconds(), [&](const float step)
+    {
+      player.savePreviousState();
+      player.move(direction * step * 300.f);
+    });
+    shapeRenderer.setInterpolation(loop.getAlpha());
 
     mk::Shapes::Collision::AABB(player.getBounds(), zone.getBounds())
       ? player.setFillColor(mk::Color::Blue)
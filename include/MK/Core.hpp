@@ -7,6 +7,9 @@
 
 #include "Core/Constants.hpp"
 #include "Core/Setup.hpp"
+#include "Core/Clock.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/Loop.hpp"
 #include "Core/File.hpp"
 #include "Core/Space.hpp"
 #include "Core/Input.hpp"
@@ -0,0 +1,154 @@
+#ifndef MK_CLOCK_HPP
+#define MK_CLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Constants.hpp"
+
+namespace mk
+{
+  namespace Core
+  {
+    /**
+     * @brief A monotonic frame clock counting time in 64-bit integer nanoseconds.
+     * Integer ticks keep full resolution however long the program runs, unlike a float number of seconds.
+     * The clock can be paused and scaled, and it keeps a rolling history of unscaled frame times for statistics.
+     */
+    class Clock
+    {
+      public:
+        /**
+         * @brief Constructs a Clock object starting now.
+         * @param historySize The number of frame times kept for statistics.
+         */
+        Clock(const std::size_t historySize = mk::Constants::CLOCK_HISTORY_SIZE);
+
+        /**
+         * @brief Reads the monotonic system timer.
+         * @return The current time in nanoseconds, from an arbitrary origin.
+         */
+        static std::int64_t now();
+
+        /**
+         * @brief Retrieves the scaled duration of the last frame.
+         * @return The delta time in seconds, or zero while paused.
+         */
+        double getDelta() const
+        { return static_cast<double>(delta) * 1e-9; }
+        /**
+         * @brief Retrieves the scaled duration of the last frame.
+         * @return The delta time in nanoseconds, or zero while paused.
+         */
+        std::int64_t getDeltaNanoseconds() const
+        { return delta; }
+        /**
+         * @brief Retrieves the real duration of the last frame, ignoring pause and scale.
+         * @return The unscaled delta time in nanoseconds.
+         */
+        std::int64_t getRawDeltaNanoseconds() const
+        { return rawDelta; }
+        /**
+         * @brief Retrieves the scaled time elapsed while the clock was running.
+         * @return The elapsed time in seconds.
+         */
+        double getElapsed() const
+        { return static_cast<double>(elapsed) * 1e-9; }
+        /**
+         * @brief Retrieves the scaled time elapsed while the clock was running.
+         * @return The elapsed time in nanoseconds.
+         */
+        std::int64_t getElapsedNanoseconds() const
+        { return elapsed; }
+        /**
+         * @brief Retrieves the real time elapsed since the clock was created or reset.
+         * @return The unscaled elapsed time in seconds.
+         */
+        double getRealElapsed() const
+        { return static_cast<double>(now() - start) * 1e-9; }
+        /**
+         * @brief Retrieves the number of frames ticked since the clock was created or reset.
+         * @return The number of frames.
+         */
+        std::uint64_t getFrameCount() const
+        { return frameCount; }
+        /**
+         * @brief Checks if the clock is paused.
+         * @return True if the clock is paused, false otherwise.
+         */
+        bool getIsPaused() const
+        { return isPaused; }
+        /**
+         * @brief Retrieves the factor applied to the time of every frame.
+         * @return The time scale.
+         */
+        double getScale() const
+        { return scale; }
+
+        /**
+         * @brief Retrieves the mean of the recorded frame times.
+         * @return The average frame time in seconds, or zero without history.
+         */
+        double getAverageFrameTime() const;
+        /**
+         * @brief Retrieves the frame rate over the recorded frame times.
+         * Averaging over the history smooths out single slow or fast frames.
+         * @return The smoothed frames per second, or zero without history.
+         */
+        double getFPS() const;
+        /**
+         * @brief Retrieves a percentile of the recorded frame times, using the nearest rank.
+         * @param percentile The percentile, from 0 (fastest frame) to 100 (slowest frame).
+         * @return The frame time in seconds, or zero without history.
+         */
+        double getPercentile(const double percentile) const;
+        /**
+         * @brief Retrieves the recorded frame times, oldest first.
+         * @return The unscaled frame times in nanoseconds.
+         */
+        std::vector<std::int64_t> getHistory() const;
+
+        /**
+         * @brief Pauses or resumes the clock. Paused frames have a zero delta and do not add to the elapsed time.
+         * @param isPaused The new pause state.
+         */
+        void setPaused(const bool isPaused)
+        { this->isPaused = isPaused; }
+        /**
+         * @brief Sets the factor applied to the time of every frame, such as for slow motion.
+         * @param scale The new time scale.
+         */
+        void setScale(const double scale)
+        { this->scale = scale; }
+
+        /**
+         * @brief Ends the current frame, measuring its duration and recording it in the history.
+         * @return The scaled delta time in nanoseconds.
+         */
+        std::int64_t tick();
+        /**
+         * @brief Restarts the clock from now and clears its elapsed time, frame count and history.
+         */
+        void reset();
+
+      private:
+        std::vector<std::int64_t>         history;
+        std::size_t                       historyIndex {0u};
+        std::size_t                       historyCount {0u};
+        std::int64_t                      historySum   {0};
+        mutable std::vector<std::int64_t> sortedHistory;
+
+        std::int64_t  start      {0};
+        std::int64_t  last       {0};
+        std::int64_t  delta      {0};
+        std::int64_t  rawDelta   {0};
+        std::int64_t  elapsed    {0};
+        std::uint64_t frameCount {0u};
+        double        scale      {1.0};
+        bool          isPaused   {false};
+    };
+  }
+}
+
+#endif // MK_CLOCK_HPP
@@ -37,6 +37,55 @@ namespace mk
      */
     constexpr unsigned int GL_MINOR_VER {3};
 
+    /**
+     * @brief The name of the std140 uniform block holding the per-frame data in shaders.
+     */
+    const std::string FRAME_UNIFORM_BLOCK {"FrameData"};
+    /**
+     * @brief The uniform buffer binding point of the per-frame data.
+     */
+    constexpr unsigned int FRAME_UNIFORM_BINDING {0u};
+
+    /**
+     * @brief The initial size in bytes of each region of the ring buffers used to stream vertex and instance data.
+     */
+    constexpr long STREAM_REGION_SIZE {256l * 1024l};
+
+    /**
+     * @brief The default number of fixed simulation steps per second.
+     */
+    constexpr double LOOP_STEP_RATE {60.0};
+    /**
+     * @brief The default maximum number of fixed simulation steps run for a single frame.
+     */
+    constexpr int LOOP_MAX_STEPS {5};
+    /**
+     * @brief The default number of frame times kept by clocks for statistics.
+     */
+    constexpr unsigned int CLOCK_HISTORY_SIZE {240u};
+    /**
+     * @brief The number of events kept by the profiler for every thread. Older events are overwritten.
+     */
+    constexpr unsigned int PROFILER_BUFFER_SIZE {65536u};
+    /**
+     * @brief The number of frames the GPU profiler keeps in flight before reading back their timer queries.
+     */
+    constexpr unsigned int GPU_PROFILER_FRAME_COUNT {3u};
+
+    /**
+     * @brief The distance by which the AABB tree fattens the bounds of its proxies, in world units.
+     */
+    constexpr float AABB_TREE_MARGIN {4.f};
+    /**
+     * @brief The default cell size of spatial hashes, in world units.
+     * Cells should be at least as large as most of the objects stored in the hash.
+     */
+    constexpr float SPATIAL_HASH_CELL_SIZE {64.f};
+    /**
+     * @brief The maximum number of vertices of a convex polygon used for collision detection.
+     */
+    constexpr int POLYGON_MAX_VERTICES {8};
+
     /**
      * @brief The size of the info log buffer used for OpenGL error messages.
      */
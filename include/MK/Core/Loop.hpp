@@ -0,0 +1,140 @@
+#ifndef MK_LOOP_HPP
+#define MK_LOOP_HPP
+
+#include <cstdint>
+
+#include "Constants.hpp"
+
+namespace mk
+{
+  namespace Core
+  {
+    /**
+     * @brief A fixed timestep driver for simulation updates.
+     * Frame times are added to an accumulator, and the update runs once for every whole step it holds, so the
+     * simulation advances by the same step whatever the render rate. Time is counted in integer nanoseconds,
+     * so the number of steps run for a sequence of frame times is exact and reproducible.
+     */
+    class Loop
+    {
+      public:
+        /**
+         * @brief Constructs a Loop object.
+         * @param stepRate The number of fixed steps per second.
+         * @param maxSteps The maximum number of steps run for a single frame. Time beyond it is dropped, so a slow
+         * frame cannot make the next one slower by queueing more steps.
+         */
+        Loop(const double stepRate = mk::Constants::LOOP_STEP_RATE, const int maxSteps = mk::Constants::LOOP_MAX_STEPS)
+        : maxSteps(maxSteps)
+        { setStepRate(stepRate); }
+
+        /**
+         * @brief Retrieves the number of fixed steps per second.
+         * @return The step rate.
+         */
+        double getStepRate() const
+        { return 1e9 / static_cast<double>(step); }
+        /**
+         * @brief Retrieves the duration of a fixed step.
+         * @return The step in seconds.
+         */
+        float getStep() const
+        { return static_cast<float>(static_cast<double>(step) * 1e-9); }
+        /**
+         * @brief Retrieves the maximum number of steps run for a single frame.
+         * @return The step cap.
+         */
+        int getMaxSteps() const
+        { return maxSteps; }
+        /**
+         * @brief Retrieves how far the accumulated time is between the last step and the next one.
+         * Rendering shapes interpolated by this amount between their previous and current states hides the
+         * difference between the step rate and the render rate.
+         * @return The interpolation factor, from 0 to 1.
+         */
+        float getAlpha() const
+        { return alpha; }
+        /**
+         * @brief Retrieves the number of steps run since the loop was created or reset.
+         * @return The number of steps.
+         */
+        std::uint64_t getStepCount() const
+        { return stepCount; }
+        /**
+         * @brief Retrieves the time dropped by the step cap since the loop was created or reset.
+         * @return The dropped time in seconds.
+         */
+        double getDroppedTime() const
+        { return static_cast<double>(droppedTime) * 1e-9; }
+
+        /**
+         * @brief Sets the number of fixed steps per second.
+         * @param stepRate The new step rate.
+         */
+        void setStepRate(const double stepRate);
+        /**
+         * @brief Sets the maximum number of steps run for a single frame.
+         * @param maxSteps The new step cap.
+         */
+        void setMaxSteps(const int maxSteps)
+        { this->maxSteps = maxSteps; }
+
+        /**
+         * @brief Adds the duration of a frame to the accumulator and takes the steps it completes.
+         * With a Clock, advanceNanoseconds takes its delta without rounding.
+         * @param frameTime The duration of the frame in seconds, usually Window::getDeltaTime.
+         * @return The number of steps to run this frame, at most the step cap.
+         */
+        int advance(const double frameTime);
+        /**
+         * @brief Adds the duration of a frame to the accumulator and takes the steps it completes.
+         * @param frameTime The duration of the frame in nanoseconds, usually Clock::getDeltaNanoseconds.
+         * @return The number of steps to run this frame, at most the step cap.
+         */
+        int advanceNanoseconds(const std::int64_t frameTime);
+        /**
+         * @brief Advances the loop by a frame and runs an update for every step taken.
+         * @param frameTime The duration of the frame in seconds.
+         * @param update A callable taking the step duration in seconds as a float.
+         * @return The number of steps run.
+         */
+        template<typename Update>
+        int run(const double frameTime, Update&& update)
+        {
+          const int steps = advance(frameTime);
+          for (int i = 0; i < steps; i++)
+            update(getStep());
+          return steps;
+        }
+        /**
+         * @brief Advances the loop by a frame and runs an update for every step taken.
+         * With a Clock, the frame time is taken without rounding through seconds.
+         * @param frameTime The duration of the frame in nanoseconds, usually Clock::getDeltaNanoseconds.
+         * @param update A callable taking the step duration in seconds as a float.
+         * @return The number of steps run.
+         */
+        template<typename Update>
+        int runNanoseconds(const std::int64_t frameTime, Update&& update)
+        {
+          const int steps = advanceNanoseconds(frameTime);
+          for (int i = 0; i < steps; i++)
+            update(getStep());
+          return steps;
+        }
+        /**
+         * @brief Empties the accumulator and clears the step count and dropped time.
+         */
+        void reset();
+
+      private:
+        std::int64_t  step        {0};  ///< The step duration in nanoseconds.
+        std::int64_t  accumulator {0};
+        std::int64_t  droppedTime {0};
+        std::uint64_t stepCount   {0u};
+        int           maxSteps    {0};
+        float         alpha       {0.f};
+    };
+  }
+}
+
+#endif // MK_LOOP_HPP
@@ -0,0 +1,109 @@
+#ifndef MK_PROFILER_HPP
+#define MK_PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Clock.hpp"
+
+#if defined(MK_ENABLE_PROFILING)
+  #define MK_PROFILE_CONCAT_IMPL(a, b) a##b
+  #define MK_PROFILE_CONCAT(a, b) MK_PROFILE_CONCAT_IMPL(a, b)
+  /**
+   * @brief Times the rest of the enclosing scope under a name, which must be a string literal.
+   */
+  #define MK_PROFILE_SCOPE(name) const mk::Core::Profiler::Scope MK_PROFILE_CONCAT(mkProfileScope, __LINE__) {name}
+  /**
+   * @brief Times the rest of the enclosing function under its name.
+   */
+  #define MK_PROFILE_FUNCTION() MK_PROFILE_SCOPE(__func__)
+#else
+  #define MK_PROFILE_SCOPE(name) static_cast<void>(0)
+  #define MK_PROFILE_FUNCTION() static_cast<void>(0)
+#endif
+
+namespace mk
+{
+  namespace Core
+  {
+    /**
+     * @brief Namespace for the scoped CPU profiler of the MK Engine.
+     * Every thread records its scopes into its own ring buffer without locking, keeping the most recent
+     * PROFILER_BUFFER_SIZE events. The scopes are placed with MK_PROFILE_SCOPE, which compiles to nothing
+     * unless MK_ENABLE_PROFILING is defined.
+     * @namespace Profiler
+     */
+    namespace Profiler
+    {
+      /**
+       * @brief Records a timed scope into the buffer of the calling thread.
+       * @param name The name of the scope. Only the pointer is stored, so it must outlive the profiler.
+       * @param start The start of the scope in nanoseconds, from Clock::now.
+       * @param end The end of the scope in nanoseconds, from Clock::now.
+       */
+      void record(const char* name, const std::int64_t start, const std::int64_t end);
+
+      /**
+       * @brief Times a scope from its construction to its destruction.
+       */
+      class Scope
+      {
+        public:
+          /**
+           * @brief Constructs a Scope object and starts timing.
+           * @param name The name of the scope, usually a string literal.
+           */
+          explicit Scope(const char* name)
+          : name(name), start(mk::Core::Clock::now())
+          {}
+          /**
+           * @brief Destroys the Scope object and records it.
+           */
+          ~Scope()
+          { record(name, start, mk::Core::Clock::now()); }
+
+          Scope(const Scope&) = delete;
+          Scope& operator=(const Scope&) = delete;
+
+        private:
+          const char*  name;
+          std::int64_t start;
+      };
+
+      /**
+       * @brief Retrieves the number of events held by the buffers of every thread.
+       * @return The number of events that would be written by a dump.
+       */
+      std::size_t getEventCount();
+      /**
+       * @brief Retrieves the number of events overwritten because a buffer was full.
+       * @return The number of lost events since the last clear.
+       */
+      std::uint64_t getDroppedCount();
+      /**
+       * @brief Discards the events of every thread.
+       */
+      void clear();
+
+      /**
+       * @brief Writes the recorded events as Chrome trace events, viewable in chrome://tracing or Perfetto.
+       * Dumps should happen while the instrumented threads are idle, such as between frames.
+       * @param path The path of the JSON file.
+       * @return True if the file was written, false otherwise.
+       */
+      bool writeChromeTrace(const std::string& path);
+      /**
+       * @brief Writes the recorded events in a compact little-endian binary format.
+       * The file starts with the "MKPF" magic and a uint32 version, followed by a uint32 name count and the
+       * names as a uint32 length and its characters. Then comes a uint64 event count and the events as a
+       * uint32 name index, a uint32 thread index, an int64 start and an int64 duration in nanoseconds.
+       * @param path The path of the binary file.
+       * @return True if the file was written, false otherwise.
+       */
+      bool writeBinary(const std::string& path);
+    }
+  }
+}
+
+#endif // MK_PROFILER_HPP
@@ -7,9 +7,17 @@ namespace mk
   {
     /**
      * Initialize GLFW (Graphics Library Framework).
+     * In headless mode GLFW uses its null platform and an EGL (or OSMesa) context, so no display is needed.
+     * Windows are then invisible and render into an offscreen framebuffer.
+     * @param headless Whether to initialize GLFW without a display.
      * @return True if GLFW was initialized successfully, false otherwise.
      */
-    bool initializeGLFW();
+    bool initializeGLFW(const bool headless = false);
+    /**
+     * Checks if GLFW was initialized in headless mode.
+     * @return True if GLFW was initialized in headless mode, false otherwise.
+     */
+    bool isHeadless();
     /**
      * Initialize GLEW (OpenGL Extension Wrangler Library).
      * @return True if GLEW was initialized successfully, false otherwise.
@@ -2,6 +2,7 @@
 #define MK_SPACE_HPP
 
 #include <cmath>
+#include <cstddef>
 
 namespace mk
 {
@@ -488,8 +489,9 @@ namespace mk
 
     /**
      * @brief A class representing a 4x4 matrix.
+     * The elements are stored row by row and aligned to 16 bytes, so each row can be loaded as one SIMD register.
      */
-    class Mat4
+    class alignas(16) Mat4
     {
       public:
         /**
@@ -537,23 +539,91 @@ namespace mk
          * @param other The matrix to multiply with.
          * @return The resulting matrix after multiplication.
          */
-        mk::Space::Mat4 operator*(const mk::Space::Mat4& mat)
-        {
-          mk::Space::Mat4 result;
-          for (int i = 0; i < 4; i++)
-            for (int j = 0; j < 4; j++)
-            {
-              result[i][j] = 0.f;
-              for (int k = 0; k < 4; k++)
-                result[i][j] += elements[i][k] * mat[k][j];
-            }
-          return result;
-        }
+        mk::Space::Mat4 operator*(const mk::Space::Mat4& mat) const;
 
       private:
-        float elements[4][4];
+        alignas(16) float elements[4][4];
     };
 
+    /**
+     * @brief Multiplies two 4x4 matrices with the fastest kernel the library was compiled for.
+     * @param matOne The left-hand matrix.
+     * @param matTwo The right-hand matrix.
+     * @return The product of the two matrices.
+     */
+    mk::Space::Mat4 multiply(const mk::Space::Mat4& matOne, const mk::Space::Mat4& matTwo);
+    /**
+     * @brief Transposes a 4x4 matrix.
+     * @param mat The matrix to transpose.
+     * @return The transposed matrix.
+     */
+    mk::Space::Mat4 transpose(const mk::Space::Mat4& mat);
+    /**
+     * @brief Inverts a 4x4 matrix.
+     * @param mat The matrix to invert.
+     * @return The inverse of the matrix, or a zero matrix if the matrix is singular.
+     */
+    mk::Space::Mat4 inverse(const mk::Space::Mat4& mat);
+    /**
+     * @brief Transforms a 2D point by a 4x4 matrix.
+     * The point is treated as a row vector with z = 0 and w = 1, matching the layout of the model matrices.
+     * @param mat The transformation matrix.
+     * @param vec The point to transform.
+     * @return The transformed point.
+     */
+    mk::Space::Vec2 transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec2& vec);
+    /**
+     * @brief Transforms a 3D point by a 4x4 matrix.
+     * The point is treated as a row vector with w = 1, and the w component of the result is discarded.
+     * @param mat The transformation matrix.
+     * @param vec The point to transform.
+     * @return The transformed point.
+     */
+    mk::Space::Vec3 transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec3& vec);
+    /**
+     * @brief Retrieves the name of the SIMD instruction set the math kernels were compiled for.
+     * @return "AVX", "SSE2" or "Scalar".
+     */
+    const char* getSIMDBackend();
+
+    /**
+     * @brief Namespace for the portable scalar versions of the math kernels.
+     * These are used when no SIMD instruction set is available and serve as the reference implementation.
+     * @namespace Scalar
+     */
+    namespace Scalar
+    {
+      /**
+       * @brief Multiplies two 4x4 matrices.
+       * @param matOne The left-hand matrix.
+       * @param matTwo The right-hand matrix.
+       * @return The product of the two matrices.
+       */
+      mk::Space::Mat4 multiply(const mk::Space::Mat4& matOne, const mk::Space::Mat4& matTwo);
+      /**
+       * @brief Transposes a 4x4 matrix.
+       * @param mat The matrix to transpose.
+       * @return The transposed matrix.
+       */
+      mk::Space::Mat4 transpose(const mk::Space::Mat4& mat);
+      /**
+       * @brief Inverts a 4x4 matrix.
+       * @param mat The matrix to invert.
+       * @return The inverse of the matrix, or a zero matrix if the matrix is singular.
+       */
+      mk::Space::Mat4 inverse(const mk::Space::Mat4& mat);
+      /**
+       * @brief Transforms a 3D point by a 4x4 matrix.
+       * @param mat The transformation matrix.
+       * @param vec The point to transform.
+       * @return The transformed point.
+       */
+      mk::Space::Vec3 transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec3& vec);
+    }
+
+    inline mk::Space::Mat4 Mat4::operator*(const mk::Space::Mat4& mat) const
+    { return mk::Space::multiply(*this, mat); }
+
     /**
      * @brief Retrieves a pointer to the raw data of a 4x4 matrix.
      * @param mat The 4x4 matrix.
@@ -608,6 +678,173 @@ namespace mk
      * @return The orthographic projection matrix.
      */
     mk::Space::Mat4 ortho(const float left, const float right, const float top, const float bottom, const float zNear, const float zFar);
+
+    /**
+     * @brief A class representing a 2D affine transform as a 2x3 matrix.
+     * A point (x, y) maps to (a * x + c * y + tx, b * x + d * y + ty). The rows are stored as (a, c, tx) and (b, d, ty),
+     * which is the column-major layout of a GLSL mat2x3, so the transform can be uploaded without conversion.
+     */
+    class Affine2D
+    {
+      public:
+        /**
+         * @brief Default constructor.
+         * Initializes the transform to the identity.
+         */
+        Affine2D()
+        {}
+        /**
+         * @brief Constructor with the six coefficients of the transform.
+         * @param a The x-coordinate of the transformed X-axis.
+         * @param b The y-coordinate of the transformed X-axis.
+         * @param c The x-coordinate of the transformed Y-axis.
+         * @param d The y-coordinate of the transformed Y-axis.
+         * @param tx The translation along the X-axis.
+         * @param ty The translation along the Y-axis.
+         */
+        Affine2D(const float a, const float b, const float c, const float d, const float tx, const float ty)
+        : elements{{a, c, tx}, {b, d, ty}}
+        {}
+
+        /**
+         * @brief Creates a transform from its components.
+         * The origin is moved to zero, then the point is scaled, rotated and finally translated.
+         * @param translation The translation applied last.
+         * @param scale The scale along both axes.
+         * @param degrees The rotation angle in degrees, using the same direction as mk::Space::rotate.
+         * @param origin The point the scale and rotation are relative to.
+         * @return The composed transform.
+         */
+        static mk::Space::Affine2D fromTransform(const mk::Space::Vec2& translation, const mk::Space::Vec2& scale, const float degrees, const mk::Space::Vec2& origin = {0.f});
+
+        /**
+         * @brief Overloaded subscript operator.
+         * Allows access to the elements of the transform.
+         * @param index The row index.
+         * @return A pointer to the array of elements in the specified row.
+         */
+        float* operator[](int index)
+        { return elements[index]; }
+        /**
+         * @brief Overloaded const subscript operator.
+         * Allows read-only access to the elements of the transform.
+         * @param index The row index.
+         * @return A const pointer to the array of elements in the specified row.
+         */
+        const float* operator[](int index) const
+        { return elements[index]; }
+        /**
+         * @brief Overloaded multiplication operator for composing transforms.
+         * Matching Mat4, the result applies this transform first and the other transform second.
+         * @param other The transform to apply after this one.
+         * @return The composed transform.
+         */
+        mk::Space::Affine2D operator*(const mk::Space::Affine2D& other) const
+        {
+          const float (&first)[3] = elements[0];
+          const float (&second)[3] = elements[1];
+          return
+          {
+            other.elements[0][0] * first[0] + other.elements[0][1] * second[0],
+            other.elements[1][0] * first[0] + other.elements[1][1] * second[0],
+            other.elements[0][0] * first[1] + other.elements[0][1] * second[1],
+            other.elements[1][0] * first[1] + other.elements[1][1] * second[1],
+            other.elements[0][0] * first[2] + other.elements[0][1] * second[2] + other.elements[0][2],
+            other.elements[1][0] * first[2] + other.elements[1][1] * second[2] + other.elements[1][2],
+          };
+        }
+
+      private:
+        float elements[2][3]
+        {
+          {1.f, 0.f, 0.f},
+          {0.f, 1.f, 0.f},
+        };
+    };
+
+    /**
+     * @brief Retrieves a pointer to the raw data of a 2D affine transform.
+     * @param affine The 2D affine transform.
+     * @return A const pointer to the six coefficients, laid out as a column-major GLSL mat2x3.
+     */
+    inline const float* valuePointer(const mk::Space::Affine2D& affine)
+    { return &affine[0][0]; }
+    /**
+     * @brief Transforms a 2D point by a 2D affine transform.
+     * @param affine The transform.
+     * @param vec The point to transform.
+     * @return The transformed point.
+     */
+    inline mk::Space::Vec2 transformPoint(const mk::Space::Affine2D& affine, const mk::Space::Vec2& vec)
+    {
+      return
+      {
+        affine[0][0] * vec.x + affine[0][1] * vec.y + affine[0][2],
+        affine[1][0] * vec.x + affine[1][1] * vec.y + affine[1][2],
+      };
+    }
+    /**
+     * @brief Inverts a 2D affine transform.
+     * @param affine The transform to invert.
+     * @return The inverse transform, or a zero transform if the transform is singular.
+     */
+    mk::Space::Affine2D inverse(const mk::Space::Affine2D& affine);
+    /**
+     * @brief Expands a 2D affine transform to a 4x4 matrix.
+     * @param affine The transform to expand.
+     * @return The equivalent 4x4 matrix, in the row-vector layout used by the other Mat4 functions.
+     */
+    mk::Space::Mat4 toMat4(const mk::Space::Affine2D& affine);
+
+    /**
+     * @brief Structure-of-arrays input of the batch transform kernels.
+     * Every array holds one value per element. The transforms match Affine2D::fromTransform with a zero origin,
+     * so the scale is the world-space size of a unit quad centered on the position.
+     */
+    struct TransformArrays
+    {
+      const float* positionX {nullptr};
+      const float* positionY {nullptr};
+      const float* scaleX    {nullptr};
+      const float* scaleY    {nullptr};
+      const float* rotation  {nullptr};
+      std::size_t  count     {0};
+    };
+
+    /**
+     * @brief Computes the affine transforms of a batch of elements.
+     * With SSE2 the kernel processes four elements per iteration using a polynomial sine and cosine.
+     * Large batches are split across threads.
+     * @param input The per-element positions, scales and rotations in degrees.
+     * @param output The buffer receiving one transform per element.
+     * @param threadCount The maximum number of threads to use, including the calling thread.
+     */
+    void computeAffines(const mk::Space::TransformArrays& input, mk::Space::Affine2D* output, const unsigned int threadCount = 1u);
+    /**
+     * @brief Computes the corners of a batch of transformed unit quads.
+     * Each element writes four corners, in the order top-left, top-right, bottom-left and bottom-right of the
+     * unit quad, which matches the index pattern of the batch renderer.
+     * @param input The per-element positions, scales and rotations in degrees.
+     * @param output The buffer receiving four corners per element.
+     * @param threadCount The maximum number of threads to use, including the calling thread.
+     */
+    void computeQuadCorners(const mk::Space::TransformArrays& input, mk::Space::Vec2* output, const unsigned int threadCount = 1u);
+
+    namespace Scalar
+    {
+      /**
+       * @brief Computes the affine transforms of a batch of elements, one element at a time.
+       * @param input The per-element positions, scales and rotations in degrees.
+       * @param output The buffer receiving one transform per element.
+       */
+      void computeAffines(const mk::Space::TransformArrays& input, mk::Space::Affine2D* output);
+      /**
+       * @brief Computes the corners of a batch of transformed unit quads, one element at a time.
+       * @param input The per-element positions, scales and rotations in degrees.
+       * @param output The buffer receiving four corners per element.
+       */
+      void computeQuadCorners(const mk::Space::TransformArrays& input, mk::Space::Vec2* output);
+    }
   }
 }
 
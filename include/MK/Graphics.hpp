@@ -9,13 +9,22 @@
 
 #include "Core/Constants.hpp"
 #include "Core/Setup.hpp"
+#include "Core/Profiler.hpp"
 #include "Core/File.hpp"
 #include "Core/Input.hpp"
 #include "Graphics/Color.hpp"
+#include "Graphics/State.hpp"
 #include "Graphics/Objects.hpp"
+#include "Graphics/RingBuffer.hpp"
+#include "Graphics/Frame.hpp"
+#include "Graphics/GPUProfiler.hpp"
+#include "Graphics/Geometry.hpp"
 #include "Graphics/Window.hpp"
 #include "Graphics/Render.hpp"
 #include "Graphics/Shapes.hpp"
+#include "Graphics/AABBTree.hpp"
+#include "Graphics/SpatialHash.hpp"
+#include "Graphics/SweepAndPrune.hpp"
 #include "Graphics/Camera.hpp"
 
 namespace mk
@@ -30,17 +39,17 @@ namespace mk
      * @brief Namespace for graphics-related functionality of the MK Engine.
      */
     inline void usePointMode()
-    { glPolygonMode(GL_FRONT_AND_BACK, GL_POINT); }
+    { mk::Graphics::StateCache::current().setPolygonMode(GL_POINT); }
     /**
      * @brief Sets the OpenGL polygon mode to line mode.
      */
     inline void useLineMode()
-    { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
+    { mk::Graphics::StateCache::current().setPolygonMode(GL_LINE); }
     /**
      * @brief Sets the OpenGL polygon mode to fill mode.
      */
     inline void useFillMode()
-    { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }
+    { mk::Graphics::StateCache::current().setPolygonMode(GL_FILL); }
   }
 }
 
@@ -0,0 +1,235 @@
+#ifndef MK_AABB_TREE_HPP
+#define MK_AABB_TREE_HPP
+
+#include <vector>
+
+#include <MK/Core/Constants.hpp>
+#include <MK/Core/Space.hpp>
+
+#include "Shapes.hpp"
+
+namespace mk
+{
+  namespace Shapes
+  {
+    namespace Collision
+    {
+      /**
+       * @brief A dynamic bounding volume tree used as a collision broadphase.
+       * Every proxy stores its tight bounds and a fattened copy used by the tree. Moves that stay inside the fat
+       * bounds do not touch the tree, and the tree is kept balanced with rotations, so queries run in
+       * logarithmic time instead of testing every pair.
+       */
+      class AABBTree
+      {
+        public:
+          /**
+           * @brief The proxy ID returned for invalid or missing proxies.
+           */
+          static constexpr int NULL_PROXY {-1};
+
+          /**
+           * @brief A pair of proxies whose tight bounds overlap.
+           */
+          using Pair = mk::Shapes::Collision::Pair;
+          /**
+           * @brief A proxy hit by a ray cast.
+           */
+          struct RaycastHit
+          {
+            int   proxy;
+            float fraction;  ///< The distance along the ray where it enters the bounds, from 0 (origin) to 1 (end).
+          };
+
+          /**
+           * @brief Constructs an empty AABBTree object.
+           * @param margin The distance by which the bounds of the proxies are fattened on every side.
+           */
+          AABBTree(const float margin = mk::Constants::AABB_TREE_MARGIN)
+          : margin(margin)
+          {}
+
+          /**
+           * @brief Retrieves the number of proxies in the tree.
+           * @return The number of proxies.
+           */
+          int getProxyCount() const
+          { return proxyCount; }
+          /**
+           * @brief Retrieves the height of the tree.
+           * @return The height of the tree, or zero if it is empty.
+           */
+          int getHeight() const
+          { return root == NULL_PROXY ? 0 : nodes[root].height; }
+          /**
+           * @brief Retrieves the user data of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The user data passed when the proxy was inserted.
+           */
+          void* getUserData(const int proxy) const
+          { return nodes[proxy].userData; }
+          /**
+           * @brief Retrieves the tight bounds of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The bounds last passed to insert or move.
+           */
+          mk::Shapes::BoundRect getBounds(const int proxy) const
+          {
+            const Node& node = nodes[proxy];
+            return {node.tightLower.x, node.tightLower.y, node.tightUpper.x - node.tightLower.x, node.tightUpper.y - node.tightLower.y};
+          }
+          /**
+           * @brief Retrieves the fattened bounds of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The bounds stored in the tree.
+           */
+          mk::Shapes::BoundRect getFatBounds(const int proxy) const
+          {
+            const Node& node = nodes[proxy];
+            return {node.lower.x, node.lower.y, node.upper.x - node.lower.x, node.upper.y - node.lower.y};
+          }
+
+          /**
+           * @brief Inserts a proxy.
+           * @param bounds The bounds of the proxy.
+           * @param userData A pointer returned by getUserData, usually the owner of the bounds.
+           * @return The ID of the new proxy.
+           */
+          int insert(const mk::Shapes::BoundRect& bounds, void* userData = nullptr);
+          /**
+           * @brief Inserts a proxy for a shape, using the shape as the user data.
+           * @param shape The shape to insert.
+           * @return The ID of the new proxy.
+           */
+          int insert(mk::Shapes::Shape& shape)
+          { return insert(shape.getBounds(), &shape); }
+          /**
+           * @brief Removes a proxy.
+           * @param proxy The ID of the proxy.
+           */
+          void remove(const int proxy);
+          /**
+           * @brief Updates the bounds of a proxy.
+           * The proxy is only reinserted if the new bounds leave its fat bounds. The fat bounds are then extended
+           * in the direction of the displacement, so a proxy moving at a steady speed is reinserted less often.
+           * @param proxy The ID of the proxy.
+           * @param bounds The new bounds of the proxy.
+           * @param displacement The distance the proxy moved since the last update.
+           * @return True if the proxy was reinserted, false otherwise.
+           */
+          bool move(const int proxy, const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& displacement = {0.f});
+          /**
+           * @brief Updates the bounds of a proxy from its shape.
+           * @param proxy The ID of the proxy.
+           * @param shape The shape the proxy was inserted for.
+           * @return True if the proxy was reinserted, false otherwise.
+           */
+          bool move(const int proxy, const mk::Shapes::Shape& shape)
+          { return move(proxy, shape.getBounds()); }
+          /**
+           * @brief Removes every proxy.
+           */
+          void clear();
+
+          /**
+           * @brief Finds the proxies whose tight bounds overlap a region.
+           * @param region The region to test.
+           * @param proxies The vector receiving the IDs of the overlapping proxies. It is cleared first.
+           */
+          void query(const mk::Shapes::BoundRect& region, std::vector<int>& proxies) const;
+          /**
+           * @brief Finds every pair of proxies whose tight bounds overlap.
+           * Each pair is reported once, with the lower proxy ID first.
+           * @param pairs The vector receiving the pairs. It is cleared first.
+           */
+          void queryPairs(std::vector<mk::Shapes::Collision::AABBTree::Pair>& pairs) const;
+          /**
+           * @brief Finds the proxies whose tight bounds are crossed by a segment.
+           * @param origin The start of the segment.
+           * @param end The end of the segment.
+           * @param hits The vector receiving the hits, sorted by fraction. It is cleared first.
+           */
+          void raycast(const mk::Space::Vec2& origin, const mk::Space::Vec2& end, std::vector<mk::Shapes::Collision::AABBTree::RaycastHit>& hits) const;
+          /**
+           * @brief Finds the first proxy whose tight bounds are crossed by a segment.
+           * Subtrees farther than the closest hit found so far are skipped.
+           * @param origin The start of the segment.
+           * @param end The end of the segment.
+           * @param hit The closest hit, if any.
+           * @return True if the segment hit a proxy, false otherwise.
+           */
+          bool raycastClosest(const mk::Space::Vec2& origin, const mk::Space::Vec2& end, mk::Shapes::Collision::AABBTree::RaycastHit& hit) const;
+          /**
+           * @brief Finds the first proxy hit by a bounding box moving along a motion vector.
+           * Subtrees the box reaches later than the closest hit found so far are skipped.
+           * @param bounds The bounding box at the start of the motion.
+           * @param motion The distance the box moves.
+           * @param hit The earliest hit and the proxy it hit, if any.
+           * @param ignoredProxy A proxy to skip, usually the one of the moving box.
+           * @return True if the box hits a proxy, false otherwise.
+           */
+          bool sweep(const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& motion, mk::Shapes::Collision::SweepHit& hit, const int ignoredProxy = NULL_PROXY) const;
+
+        private:
+          /**
+           * @brief A node of the tree. Leaves hold proxies, and internal nodes bound their two children.
+           */
+          struct Node
+          {
+            mk::Space::Vec2 lower;
+            mk::Space::Vec2 upper;
+            mk::Space::Vec2 tightLower;
+            mk::Space::Vec2 tightUpper;
+            void*           userData {nullptr};
+            int             parent   {NULL_PROXY};  ///< The next free node while the node is in the free list.
+            int             childOne {NULL_PROXY};
+            int             childTwo {NULL_PROXY};
+            int             height   {-1};          ///< Zero for leaves and -1 for free nodes.
+
+            bool isLeaf() const
+            { return childOne == NULL_PROXY; }
+          };
+
+          std::vector<Node> nodes;
+          int   root       {NULL_PROXY};
+          int   freeList   {NULL_PROXY};
+          int   proxyCount {0};
+          float margin     {0.f};
+
+          /**
+           * @brief Takes a node from the free list, growing the node pool if needed.
+           * @return The index of the node.
+           */
+          int _allocateNode();
+          /**
+           * @brief Returns a node to the free list.
+           * @param index The index of the node.
+           */
+          void _freeNode(const int index);
+          /**
+           * @brief Inserts a leaf next to the sibling that least increases the total perimeter of the tree.
+           * @param leaf The index of the leaf.
+           */
+          void _insertLeaf(const int leaf);
+          /**
+           * @brief Detaches a leaf and replaces its parent with its sibling.
+           * @param leaf The index of the leaf.
+           */
+          void _removeLeaf(const int leaf);
+          /**
+           * @brief Rotates a subtree whose children differ in height by more than one.
+           * @param index The index of the root of the subtree.
+           * @return The index of the new root of the subtree.
+           */
+          int _balance(const int index);
+          /**
+           * @brief Recomputes the bounds and height of every ancestor of a node, balancing them on the way.
+           * @param index The index of the first ancestor.
+           */
+          void _refit(int index);
+      };
+    }
+  }
+}
+
+#endif // MK_AABB_TREE_HPP
@@ -3,6 +3,7 @@
 
 #include <MK/Core/Space.hpp>
 
+#include "Frame.hpp"
 #include "Objects.hpp"
 
 namespace mk
@@ -66,11 +67,11 @@ namespace mk
        */
       virtual void updateMatrix() = 0;
       /**
-       * @brief Applies the camera matrix to a shader.
-       * @param shader The shader to which the camera matrix will be applied.
+       * @brief Applies the camera matrix and viewport to the per-frame uniform buffer shared by all shaders.
+       * Nothing is uploaded if they did not change since the last upload.
        */
-      void applyMatrix(const mk::Graphics::Shader& shader)
-      { shader.SetMat4("cameraMatrix", matrix); }
+      void applyMatrix() const
+      { mk::Graphics::FrameUniforms::current().setCamera(matrix, viewport); }
 
     protected:
       mk::Space::Vec2 bufferDimensions {0.f};
@@ -78,6 +79,7 @@ namespace mk
       float zFar {0.f};
 
       mk::Space::Mat4 matrix {1.f};
+      GLfloat viewport[4] {0.f, 0.f, 0.f, 0.f};
   };
 
   /**
@@ -0,0 +1,87 @@
+#ifndef MK_FRAME_HPP
+#define MK_FRAME_HPP
+
+#include <GL/glew.h>
+#include <memory>
+
+#include <MK/Core/Space.hpp>
+
+#include "Objects.hpp"
+
+namespace mk
+{
+  namespace Graphics
+  {
+    /**
+     * @brief The per-frame data shared by every shader program, laid out as the std140 FrameData block.
+     */
+    struct FrameData
+    {
+      GLfloat cameraMatrix[16];
+      GLfloat viewport[4];
+      GLfloat time;
+      GLfloat padding[3];
+    };
+    static_assert(sizeof(mk::Graphics::FrameData) == 96, "FrameData must match the std140 layout of the FrameData block");
+
+    /**
+     * @brief A per-context uniform buffer holding the FrameData block.
+     * The buffer is bound once at Constants::FRAME_UNIFORM_BINDING, and only the fields that
+     * changed since the last upload are written to it.
+     */
+    class FrameUniforms
+    {
+      public:
+        /**
+         * @brief Retrieves the frame uniforms of the current context.
+         * If no window has made its context current, a fallback instance is returned.
+         * @return A reference to the current frame uniforms.
+         */
+        static mk::Graphics::FrameUniforms& current();
+        /**
+         * @brief Sets the frame uniforms of the current context.
+         * @param frameUniforms A pointer to the new current frame uniforms, or nullptr to use the fallback instance.
+         */
+        static void setCurrent(mk::Graphics::FrameUniforms* frameUniforms);
+
+        /**
+         * @brief Retrieves the CPU-side copy of the per-frame data.
+         * @return The per-frame data as last uploaded.
+         */
+        const mk::Graphics::FrameData& getData() const
+        { return data; }
+        /**
+         * @brief Retrieves the number of uploads made to the uniform buffer.
+         * @return The number of uploads.
+         */
+        unsigned long getUploads() const
+        { return uploads; }
+
+        /**
+         * @brief Sets the camera matrix and viewport.
+         * @param cameraMatrix The camera matrix.
+         * @param viewport The viewport as x, y, width and height.
+         */
+        void setCamera(const mk::Space::Mat4& cameraMatrix, const GLfloat viewport[4]);
+        /**
+         * @brief Sets the time.
+         * @param time The time in seconds.
+         */
+        void setTime(const GLfloat time);
+
+      private:
+        std::unique_ptr<mk::Graphics::UBO> UBO;
+        mk::Graphics::FrameData data {};
+        unsigned long uploads {0};
+
+        /**
+         * @brief Writes a range of the per-frame data to the uniform buffer, creating and binding it on first use.
+         * @param offset The offset of the range in bytes.
+         * @param size The size of the range in bytes.
+         */
+        void _upload(const GLintptr offset, const GLsizeiptr size);
+    };
+  }
+}
+
+#endif // MK_FRAME_HPP
@@ -0,0 +1,167 @@
+#ifndef MK_GPU_PROFILER_HPP
+#define MK_GPU_PROFILER_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <MK/Core/Constants.hpp>
+
+namespace mk
+{
+  namespace Graphics
+  {
+    /**
+     * @brief The GPU time spent in a named pass of a frame.
+     */
+    struct GPUPass
+    {
+      const char*  name;
+      std::int64_t start;     ///< The start of the pass in nanoseconds, relative to the start of the frame.
+      std::int64_t duration;  ///< The duration of the pass in nanoseconds.
+      int          depth;     ///< Zero for top-level passes, and one more for every enclosing pass.
+    };
+
+    /**
+     * @brief A per-context GPU profiler timing named passes with timestamp queries.
+     * Every pass boundary writes a timestamp query, and the queries of a frame are only read back
+     * GPU_PROFILER_FRAME_COUNT frames later, once the GPU has long finished them, so reading never stalls.
+     * Comparing the GPU frame time with the CPU one tells whether frames are bound by submission or by the GPU.
+     * The window opens frames in update, times the clear, every renderer use block and the display as passes,
+     * and closes frames in display. Profiling is disabled until setEnabled is called.
+     */
+    class GPUProfiler
+    {
+      public:
+        GPUProfiler() = default;
+        /**
+         * @brief Destructor for GPUProfiler object.
+         * Deletes the query objects, so the context that created them must still be current.
+         */
+        ~GPUProfiler();
+
+        GPUProfiler(const GPUProfiler&) = delete;
+        GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+        /**
+         * @brief Retrieves the GPU profiler of the current context.
+         * If no window has made its context current, a fallback instance is returned.
+         * @return A reference to the current GPU profiler.
+         */
+        static mk::Graphics::GPUProfiler& current();
+        /**
+         * @brief Sets the GPU profiler of the current context.
+         * @param profiler A pointer to the new current GPU profiler, or nullptr to use the fallback instance.
+         */
+        static void setCurrent(mk::Graphics::GPUProfiler* profiler);
+
+        /**
+         * @brief Checks if the profiler issues queries.
+         * @return True if profiling is enabled, false otherwise.
+         */
+        bool getIsEnabled() const
+        { return isEnabled; }
+        /**
+         * @brief Retrieves the passes of the last frame read back.
+         * @return The passes in the order they began.
+         */
+        const std::vector<mk::Graphics::GPUPass>& getPasses() const
+        { return passes; }
+        /**
+         * @brief Retrieves the GPU time of the last frame read back.
+         * @return The frame time in seconds, or zero before the first readback.
+         */
+        double getFrameTime() const
+        { return static_cast<double>(frameTime) * 1e-9; }
+        /**
+         * @brief Retrieves the GPU time of the last frame read back.
+         * @return The frame time in nanoseconds, or zero before the first readback.
+         */
+        std::int64_t getFrameTimeNanoseconds() const
+        { return frameTime; }
+        /**
+         * @brief Retrieves the number of frames whose results were not ready when their queries had to be reused.
+         * @return The number of dropped frames.
+         */
+        std::uint64_t getDroppedFrames() const
+        { return droppedFrames; }
+
+        /**
+         * @brief Enables or disables profiling. Timer queries need OpenGL 3.3 or ARB_timer_query.
+         * @param isEnabled The new profiling state.
+         */
+        void setEnabled(const bool isEnabled);
+
+        /**
+         * @brief Reads back the oldest frame in flight and starts timing a new frame.
+         * A frame still open is ended first.
+         */
+        void beginFrame();
+        /**
+         * @brief Ends every open pass and the frame.
+         */
+        void endFrame();
+        /**
+         * @brief Starts a pass nested in the current one.
+         * @param name The name of the pass. Only the pointer is stored, so it is usually a string literal.
+         */
+        void beginPass(const char* name);
+        /**
+         * @brief Ends the innermost open pass.
+         */
+        void endPass();
+        /**
+         * @brief Ends every open pass and starts a new top-level one.
+         * Consecutive blocks such as renderers split the frame this way without explicit ends.
+         * @param name The name of the pass. Only the pointer is stored, so it is usually a string literal.
+         */
+        void nextPass(const char* name);
+
+      private:
+        /**
+         * @brief A pass of a frame in flight and the indices of its timestamp queries.
+         */
+        struct PendingPass
+        {
+          const char* name;
+          int         beginQuery;
+          int         endQuery;
+          int         depth;
+        };
+        /**
+         * @brief The queries and passes of a frame in flight. The query objects are kept and reused.
+         */
+        struct Frame
+        {
+          std::vector<GLuint>      queries;
+          std::vector<PendingPass> passes;
+          int                      queryCount {0};
+          bool                     isPending  {false};
+        };
+
+        std::array<Frame, mk::Constants::GPU_PROFILER_FRAME_COUNT> frames;
+        std::vector<int>                   openPasses;
+        std::vector<mk::Graphics::GPUPass> passes;
+        std::vector<GLuint64>              timestamps;
+        std::int64_t                       frameTime     {0};
+        std::uint64_t                      droppedFrames {0u};
+        unsigned int                       frameIndex    {0u};
+        bool                               isEnabled     {false};
+        bool                               isFrameOpen   {false};
+
+        /**
+         * @brief Writes a timestamp query for the current frame, creating query objects as needed.
+         * @return The index of the query in the frame.
+         */
+        int _timestamp();
+        /**
+         * @brief Reads back the passes of a frame in flight if all of its queries are available.
+         * @param frame The frame to read back.
+         */
+        void _collect(Frame& frame);
+    };
+  }
+}
+
+#endif // MK_GPU_PROFILER_HPP
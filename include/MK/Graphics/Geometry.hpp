@@ -0,0 +1,74 @@
+#ifndef MK_GEOMETRY_HPP
+#define MK_GEOMETRY_HPP
+
+#include <GL/glew.h>
+
+#include "Objects.hpp"
+
+namespace mk
+{
+  namespace Graphics
+  {
+    /**
+     * @brief Enumeration of the shared geometries known to the geometry registry.
+     * @enum Primitive
+     */
+    enum class Primitive
+    {
+      Quad,  ///< A unit quad centered on the origin, spanning [-0.5, 0.5] on both axes.
+      Count,
+    };
+
+    /**
+     * @brief The GPU objects of a shared geometry.
+     */
+    struct Geometry
+    {
+      mk::Graphics::VAO* VAO {nullptr};
+      mk::Graphics::VBO* VBO {nullptr};
+      mk::Graphics::EBO* EBO {nullptr};
+      GLsizei indexCount {0};
+    };
+
+    /**
+     * @brief A reference-counted registry of the geometries shared by all shapes.
+     * Retaining and releasing a primitive only touches a counter, so shapes can be created without
+     * allocating or calling OpenGL. The GPU objects are created on first use and deleted
+     * when the last reference is released.
+     */
+    class GeometryRegistry
+    {
+      public:
+        /**
+         * @brief Adds a reference to a primitive.
+         * @param primitive The primitive to retain.
+         */
+        static void retain(const mk::Graphics::Primitive primitive);
+        /**
+         * @brief Removes a reference to a primitive, deleting its GPU objects when no references remain.
+         * @param primitive The primitive to release.
+         */
+        static void release(const mk::Graphics::Primitive primitive);
+        /**
+         * @brief Retrieves the GPU objects of a primitive, creating them if needed.
+         * @param primitive The primitive to retrieve.
+         * @return The geometry of the primitive, with null objects if the primitive has no geometry.
+         */
+        static const mk::Graphics::Geometry& get(const mk::Graphics::Primitive primitive);
+        /**
+         * @brief Retrieves the number of indices of a primitive without creating its GPU objects.
+         * @param primitive The primitive.
+         * @return The number of indices.
+         */
+        static GLsizei getIndexCount(const mk::Graphics::Primitive primitive);
+        /**
+         * @brief Retrieves the number of references to a primitive.
+         * @param primitive The primitive.
+         * @return The reference count.
+         */
+        static unsigned int getRefCount(const mk::Graphics::Primitive primitive);
+    };
+  }
+}
+
+#endif // MK_GEOMETRY_HPP
@@ -2,14 +2,134 @@
 #define MK_OBJECTS_HPP
 
 #include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <MK/Core/Space.hpp>
 
+#include "State.hpp"
+
 namespace mk
 {
   namespace Graphics
   {
+    class RingBuffer;
+
+    /**
+     * @brief Describes an active uniform variable of a linked shader program.
+     */
+    struct UniformInfo
+    {
+      std::string name;
+      GLint       location {-1};
+      GLenum      type     {0};
+      GLint       size     {0};
+    };
+
+    /**
+     * @brief Describes an active vertex attribute of a linked shader program.
+     */
+    struct AttributeInfo
+    {
+      std::string name;
+      GLint       location {-1};
+      GLenum      type     {0};
+      GLint       size     {0};
+    };
+
+    /**
+     * @brief Maps a C++ value type to the OpenGL uniform types it can be uploaded to.
+     * @tparam T The C++ value type.
+     */
+    template<typename T>
+    struct UniformTraits;
+
+    template<>
+    struct UniformTraits<float>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_FLOAT; }
+    };
+
+    template<>
+    struct UniformTraits<int>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D; }
+    };
+
+    template<>
+    struct UniformTraits<mk::Space::Vec2>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_FLOAT_VEC2; }
+    };
+
+    template<>
+    struct UniformTraits<mk::Space::Vec3>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_FLOAT_VEC3; }
+    };
+
+    template<>
+    struct UniformTraits<mk::Space::Mat4>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_FLOAT_MAT4; }
+    };
+
+    template<>
+    struct UniformTraits<mk::Space::Affine2D>
+    {
+      static bool accepts(const GLenum type)
+      { return type == GL_FLOAT_MAT2x3; }
+    };
+
+    /**
+     * @brief A typed handle to a uniform in a shader's reflection table.
+     * Handles are obtained once through Shader::getUniform and stay valid for the lifetime of the shader.
+     * @tparam T The C++ value type of the uniform.
+     */
+    template<typename T>
+    class Uniform
+    {
+      public:
+        /**
+         * @brief Constructs an invalid uniform handle.
+         */
+        Uniform()
+        {}
+        /**
+         * @brief Constructs a uniform handle pointing to a reflection table entry.
+         * @param index The index of the uniform in the reflection table.
+         */
+        explicit Uniform(const int index)
+        : index(index)
+        {}
+
+        /**
+         * @brief Checks if the handle points to an active uniform.
+         * @return True if the handle is valid, false otherwise.
+         */
+        bool isValid() const
+        { return index >= 0; }
+        /**
+         * @brief Retrieves the index of the uniform in the reflection table.
+         * @return The index of the uniform, or -1 if the handle is invalid.
+         */
+        int getIndex() const
+        { return index; }
+
+      private:
+        int index {-1};
+    };
+
     /**
      * @brief A class representing a shader program in OpenGL.
      */
@@ -18,6 +138,7 @@ namespace mk
       public:
         /**
          * @brief Constructs a Shader object from vertex and fragment shader files.
+         * After linking, every active uniform and attribute is recorded in a reflection table.
          * @param vertexPath The file path to the vertex shader source code.
          * @param fragmentPath The file path to the fragment shader source code.
          */
@@ -34,41 +155,187 @@ namespace mk
          */
         GLuint getID() const
         { return ID; }
+        /**
+         * @brief Retrieves the active uniforms of the shader program.
+         * @return The uniform reflection table.
+         */
+        const std::vector<mk::Graphics::UniformInfo>& getUniforms() const
+        { return uniforms; }
+        /**
+         * @brief Retrieves the active vertex attributes of the shader program.
+         * @return The attribute reflection table.
+         */
+        const std::vector<mk::Graphics::AttributeInfo>& getAttributes() const
+        { return attributes; }
+        /**
+         * @brief Retrieves the location of an active vertex attribute.
+         * @param attribute The name of the attribute in the shader.
+         * @return The location of the attribute, or -1 if it is not active.
+         */
+        GLint getAttributeLocation(const std::string& attribute) const
+        {
+          for (const auto& info : attributes)
+            if (info.name == attribute)
+              return info.location;
+          return -1;
+        }
+        /**
+         * @brief Retrieves a typed handle to an active uniform.
+         * @tparam T The C++ value type of the uniform.
+         * @param uniform The name of the uniform variable in the shader.
+         * @return A handle to the uniform. The handle is invalid if the uniform is not active or its type does not match.
+         */
+        template<typename T>
+        mk::Graphics::Uniform<T> getUniform(const std::string& uniform) const
+        {
+          const int index = _findUniform(uniform);
+          if (index < 0)
+            return {};
+          if (!mk::Graphics::UniformTraits<T>::accepts(uniforms[index].type))
+          {
+            std::cerr << "Uniform type mismatch (" << uniform << ")!\n";
+            return {};
+          }
+          return mk::Graphics::Uniform<T>(index);
+        }
 
+        /**
+         * @brief Sets an integer uniform in the shader program.
+         * @param uniform The handle of the uniform.
+         * @param value The integer to set.
+         */
+        void SetInt(const mk::Graphics::Uniform<int>& uniform, const int value) const
+        {
+          if (_updateShadow(uniform.getIndex(), &value, sizeof(value)))
+            glUniform1i(uniforms[uniform.getIndex()].location, value);
+        }
+        /**
+         * @brief Sets a float uniform in the shader program.
+         * @param uniform The handle of the uniform.
+         * @param value The float to set.
+         */
+        void SetFloat(const mk::Graphics::Uniform<float>& uniform, const float value) const
+        {
+          if (_updateShadow(uniform.getIndex(), &value, sizeof(value)))
+            glUniform1f(uniforms[uniform.getIndex()].location, value);
+        }
+        /**
+         * @brief Sets a 2-component vector uniform in the shader program.
+         * @param uniform The handle of the uniform.
+         * @param vec The 2-component vector to set.
+         */
+        void SetVec2(const mk::Graphics::Uniform<mk::Space::Vec2>& uniform, const mk::Space::Vec2& vec) const
+        {
+          const GLfloat values[2] {vec.x, vec.y};
+          if (_updateShadow(uniform.getIndex(), values, sizeof(values)))
+            glUniform2f(uniforms[uniform.getIndex()].location, vec.x, vec.y);
+        }
         /**
          * @brief Sets a 3-component vector uniform in the shader program.
-         * @param uniform The name of the uniform variable in the shader.
+         * @param uniform The handle of the uniform.
          * @param vec The 3-component vector to set.
          */
-        void SetVec3(const std::string& uniform, const mk::Space::Vec3& vec) const
+        void SetVec3(const mk::Graphics::Uniform<mk::Space::Vec3>& uniform, const mk::Space::Vec3& vec) const
         {
-          GLuint vecLoc = glGetUniformLocation(ID, uniform.c_str());
-          glUniform3f(vecLoc, vec.x, vec.y, vec.z);
+          const GLfloat values[3] {vec.x, vec.y, vec.z};
+          if (_updateShadow(uniform.getIndex(), values, sizeof(values)))
+            glUniform3f(uniforms[uniform.getIndex()].location, vec.x, vec.y, vec.z);
         }
         /**
          * @brief Sets a 4x4 matrix uniform in the shader program.
-         * @param uniform The name of the uniform variable in the shader.
+         * @param uniform The handle of the uniform.
          * @param mat The 4x4 matrix to set.
          */
-        void SetMat4(const std::string& uniform, const mk::Space::Mat4& mat) const
+        void SetMat4(const mk::Graphics::Uniform<mk::Space::Mat4>& uniform, const mk::Space::Mat4& mat) const
         {
-          GLuint matLoc = glGetUniformLocation(ID, uniform.c_str());
-          glUniformMatrix4fv(matLoc, 1, GL_FALSE, mk::Space::valuePointer(mat));
+          if (_updateShadow(uniform.getIndex(), mk::Space::valuePointer(mat), 16 * sizeof(GLfloat)))
+            glUniformMatrix4fv(uniforms[uniform.getIndex()].location, 1, GL_FALSE, mk::Space::valuePointer(mat));
         }
+        /**
+         * @brief Sets a 2D affine transform uniform (a GLSL mat2x3) in the shader program.
+         * @param uniform The handle of the uniform.
+         * @param affine The 2D affine transform to set.
+         */
+        void SetAffine2D(const mk::Graphics::Uniform<mk::Space::Affine2D>& uniform, const mk::Space::Affine2D& affine) const
+        {
+          if (_updateShadow(uniform.getIndex(), mk::Space::valuePointer(affine), 6 * sizeof(GLfloat)))
+            glUniformMatrix2x3fv(uniforms[uniform.getIndex()].location, 1, GL_FALSE, mk::Space::valuePointer(affine));
+        }
+        /**
+         * @brief Sets a 3-component vector uniform in the shader program.
+         * Prefer the handle overload on hot paths, as this one looks the uniform up by name.
+         * @param uniform The name of the uniform variable in the shader.
+         * @param vec The 3-component vector to set.
+         */
+        void SetVec3(const std::string& uniform, const mk::Space::Vec3& vec) const
+        { SetVec3(mk::Graphics::Uniform<mk::Space::Vec3>(_findUniform(uniform)), vec); }
+        /**
+         * @brief Sets a 4x4 matrix uniform in the shader program.
+         * Prefer the handle overload on hot paths, as this one looks the uniform up by name.
+         * @param uniform The name of the uniform variable in the shader.
+         * @param mat The 4x4 matrix to set.
+         */
+        void SetMat4(const std::string& uniform, const mk::Space::Mat4& mat) const
+        { SetMat4(mk::Graphics::Uniform<mk::Space::Mat4>(_findUniform(uniform)), mat); }
 
         /**
          * @brief Activates the shader program.
          */
         void Use() const
-        { glUseProgram(this->ID); }
+        { mk::Graphics::StateCache::current().useProgram(this->ID); }
         /**
-         * @brief Deletes the shader program.
+         * @brief Deletes the shader program. Deleting it again does nothing.
          */
-        void Delete() const
-        { glDeleteProgram(this->ID); }
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteProgram(this->ID);
+          mk::Graphics::StateCache::current().forgetProgram(this->ID);
+          this->ID = 0;
+        }
 
       private:
         GLuint ID {0};
+
+        std::vector<mk::Graphics::UniformInfo>     uniforms;
+        std::vector<mk::Graphics::AttributeInfo>   attributes;
+        std::unordered_map<std::string, int>       uniformIndices;
+        mutable std::vector<std::array<GLfloat, 16>> uniformShadows;
+        mutable std::vector<bool>                    uniformUploaded;
+
+        /**
+         * @brief Enumerates the active uniforms and attributes of the linked program.
+         */
+        void _reflect();
+        /**
+         * @brief Looks up a uniform in the reflection table.
+         * @param uniform The name of the uniform variable in the shader.
+         * @return The index of the uniform, or -1 if it is not active.
+         */
+        int _findUniform(const std::string& uniform) const
+        {
+          auto it = uniformIndices.find(uniform);
+          return it != uniformIndices.end() ? it->second : -1;
+        }
+        /**
+         * @brief Compares a value against the CPU-side shadow of a uniform and records it if it differs.
+         * @param index The index of the uniform in the reflection table.
+         * @param data The value to upload.
+         * @param size The size of the value in bytes.
+         * @return True if the value has to be uploaded, false if it is invalid or identical to the last upload.
+         */
+        bool _updateShadow(const int index, const void* data, const std::size_t size) const
+        {
+          if (index < 0)
+            return false;
+          if (uniformUploaded[index] && std::memcmp(uniformShadows[index].data(), data, size) == 0)
+            return false;
+          std::memcpy(uniformShadows[index].data(), data, size);
+          uniformUploaded[index] = true;
+          mk::Graphics::StateCache::current().recordUniformUpload();
+          return true;
+        }
     };
 
     /**
@@ -86,9 +353,11 @@ namespace mk
         VBO(const std::array<GLfloat, size>& vertices)
         {
           glGenBuffers(1, &this->ID);
-          glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+          mk::Graphics::StateCache& cache = mk::Graphics::StateCache::current();
+          cache.trackBuffer();
+          cache.bindBuffer(GL_ARRAY_BUFFER, this->ID);
           glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-          glBindBuffer(GL_ARRAY_BUFFER, 0);
+          cache.recordUpload(vertices.size() * sizeof(GLfloat));
         }
         /**
          * @brief Destructor for VAO object.
@@ -107,17 +376,23 @@ namespace mk
          * @brief Binds the VBO.
          */
         void Bind() const
-        { glBindBuffer(GL_ARRAY_BUFFER, this->ID); }
+        { mk::Graphics::StateCache::current().bindBuffer(GL_ARRAY_BUFFER, this->ID); }
         /**
          * @brief Unbinds the VBO.
          */
         void Unbind() const
-        { glBindBuffer(GL_ARRAY_BUFFER, 0); }
+        { mk::Graphics::StateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0); }
         /**
-         * @brief Deletes the VBO.
+         * @brief Deletes the VBO. Deleting it again does nothing.
          */
-        void Delete() const
-        { glDeleteBuffers(1, &this->ID); }
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteBuffers(1, &this->ID);
+          mk::Graphics::StateCache::current().forgetBuffer(this->ID);
+          this->ID = 0;
+        }
 
       private:
         GLuint ID {0};
@@ -136,11 +411,24 @@ namespace mk
          */
         template<std::size_t size>
         EBO(const std::array<GLuint, size>& indices)
+        {
+          // Uploaded through GL_ARRAY_BUFFER so the element binding of the bound VAO is left untouched
+          glGenBuffers(1, &this->ID);
+          mk::Graphics::StateCache& cache = mk::Graphics::StateCache::current();
+          cache.trackBuffer();
+          cache.bindBuffer(GL_ARRAY_BUFFER, this->ID);
+          glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+          cache.recordUpload(indices.size() * sizeof(GLuint));
+        }
+        /**
+         * @brief Constructs an empty EBO object whose data is supplied later through SetData.
+         * @param usage The expected usage pattern of the data store (e.g. GL_DYNAMIC_DRAW).
+         */
+        EBO(const GLenum usage)
+        : usage(usage)
         {
           glGenBuffers(1, &this->ID);
-          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ID);
-          glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLfloat), indices.data(), GL_STATIC_DRAW);
-          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+          mk::Graphics::StateCache::current().trackBuffer();
         }
         /**
          * @brief Destructor for EBO object.
@@ -159,20 +447,182 @@ namespace mk
          * @brief Binds the EBO.
          */
         void Bind() const
-        { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ID); }
+        { mk::Graphics::StateCache::current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ID); }
         /**
          * @brief Unbinds the EBO.
          */
         void Unbind() const
-        { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
+        { mk::Graphics::StateCache::current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
         /**
-         * @brief Deletes the EBO.
+         * @brief Deletes the EBO. Deleting it again does nothing.
          */
-        void Delete() const
-        { glDeleteBuffers(1, &this->ID); }
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteBuffers(1, &this->ID);
+          mk::Graphics::StateCache::current().forgetBuffer(this->ID);
+          this->ID = 0;
+        }
+        /**
+         * @brief Replaces the data store of the EBO.
+         * The EBO is left bound to GL_ELEMENT_ARRAY_BUFFER, so the owning VAO must be bound.
+         * @param indices A pointer to the index data to upload.
+         * @param size The size of the index data in bytes.
+         */
+        void SetData(const GLuint* indices, const GLsizeiptr size) const
+        {
+          Bind();
+          glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, usage);
+          mk::Graphics::StateCache::current().recordUpload(size);
+        }
 
       private:
         GLuint ID {0};
+        GLenum usage {GL_STATIC_DRAW};
+    };
+
+    /**
+     * @brief A class representing a Uniform Buffer Object (UBO) in OpenGL.
+     */
+    class UBO
+    {
+      public:
+        /**
+         * @brief Constructs a UBO object with an uninitialized data store of the specified size.
+         * @param size The size of the data store in bytes.
+         */
+        UBO(const GLsizeiptr size)
+        {
+          glGenBuffers(1, &this->ID);
+          mk::Graphics::StateCache::current().trackBuffer();
+          Bind();
+          glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+        }
+        /**
+         * @brief Destructor for UBO object.
+         */
+        ~UBO()
+        { Delete(); }
+
+        /**
+         * @brief Retrieves the ID of the UBO.
+         * @return The ID of the UBO.
+         */
+        GLuint getID() const
+        { return ID; }
+
+        /**
+         * @brief Binds the UBO.
+         */
+        void Bind() const
+        { mk::Graphics::StateCache::current().bindBuffer(GL_UNIFORM_BUFFER, this->ID); }
+        /**
+         * @brief Binds the UBO to an indexed uniform buffer binding point.
+         * @param binding The binding point shared with the shader programs.
+         */
+        void BindBase(const GLuint binding) const
+        { glBindBufferBase(GL_UNIFORM_BUFFER, binding, this->ID); }
+        /**
+         * @brief Deletes the UBO. Deleting it again does nothing.
+         */
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteBuffers(1, &this->ID);
+          mk::Graphics::StateCache::current().forgetBuffer(this->ID);
+          this->ID = 0;
+        }
+        /**
+         * @brief Updates a range of the data store.
+         * @param offset The offset of the range in bytes.
+         * @param size The size of the range in bytes.
+         * @param data A pointer to the new data.
+         */
+        void SetSubData(const GLintptr offset, const GLsizeiptr size, const void* data) const
+        {
+          Bind();
+          glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+          mk::Graphics::StateCache::current().recordUpload(size);
+        }
+
+      private:
+        GLuint ID {0};
+    };
+
+    /**
+     * @brief A class representing a Framebuffer Object (FBO) in OpenGL.
+     * The framebuffer has a single RGBA8 color renderbuffer and is used as the render target of headless windows.
+     */
+    class FBO
+    {
+      public:
+        /**
+         * @brief Constructs an FBO object with a color attachment of the specified size.
+         * @param width The width of the color attachment.
+         * @param height The height of the color attachment.
+         */
+        FBO(const GLsizei width, const GLsizei height);
+        /**
+         * @brief Destructor for FBO object.
+         */
+        ~FBO()
+        { Delete(); }
+
+        /**
+         * @brief Retrieves the ID of the FBO.
+         * @return The ID of the FBO.
+         */
+        GLuint getID() const
+        { return ID; }
+        /**
+         * @brief Retrieves the width of the color attachment.
+         * @return The width of the color attachment.
+         */
+        GLsizei getWidth() const
+        { return width; }
+        /**
+         * @brief Retrieves the height of the color attachment.
+         * @return The height of the color attachment.
+         */
+        GLsizei getHeight() const
+        { return height; }
+
+        /**
+         * @brief Binds the FBO as the draw and read framebuffer.
+         */
+        void Bind() const
+        { mk::Graphics::StateCache::current().bindFramebuffer(this->ID); }
+        /**
+         * @brief Binds the default framebuffer.
+         */
+        void Unbind() const
+        { mk::Graphics::StateCache::current().bindFramebuffer(0); }
+        /**
+         * @brief Deletes the FBO and its color attachment. Deleting it again does nothing.
+         */
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteFramebuffers(1, &this->ID);
+          glDeleteRenderbuffers(1, &this->colorID);
+          mk::Graphics::StateCache::current().forgetFramebuffer(this->ID);
+          this->ID = 0;
+          this->colorID = 0;
+        }
+        /**
+         * @brief Reads back the contents of the color attachment.
+         * @return The pixels as tightly packed RGBA bytes, with the top row first.
+         */
+        std::vector<std::uint8_t> ReadPixels() const;
+
+      private:
+        GLuint  ID      {0};
+        GLuint  colorID {0};
+        GLsizei width   {0};
+        GLsizei height  {0};
     };
 
     /**
@@ -185,7 +635,10 @@ namespace mk
          * @brief Constructs a VAO object.
          */
         VAO()
-        { glGenVertexArrays(1, &this->ID); };
+        {
+          glGenVertexArrays(1, &this->ID);
+          mk::Graphics::StateCache::current().trackVertexArray();
+        }
         /**
          * @brief Destructor for VAO object.
          */
@@ -203,17 +656,23 @@ namespace mk
          * @brief Binds the VAO.
          */
         void Bind() const
-        { glBindVertexArray(this->ID); }
+        { mk::Graphics::StateCache::current().bindVertexArray(this->ID); }
         /**
          * @brief Unbinds the VAO.
          */
         void Unbind() const
-        { glBindVertexArray(0); }
+        { mk::Graphics::StateCache::current().bindVertexArray(0); }
         /**
-         * @brief Deletes the VAO.
+         * @brief Deletes the VAO. Deleting it again does nothing.
          */
-        void Delete() const
-        { glDeleteVertexArrays(1, &this->ID); }
+        void Delete()
+        {
+          if (this->ID == 0)
+            return;
+          glDeleteVertexArrays(1, &this->ID);
+          mk::Graphics::StateCache::current().forgetVertexArray(this->ID);
+          this->ID = 0;
+        }
         /**
          * @brief Links a VBO to this VAO.
          * @param VBO     The VBO to link.
@@ -224,6 +683,24 @@ namespace mk
          * @param offset  The offset of the first component of the first vertex attribute in the array in the data store of the buffer currently bound to the GL_ARRAY_BUFFER target.
          */
         void LinkAttrib(const mk::Graphics::VBO& VBO, GLuint layout, GLuint size, GLenum type, GLsizeiptr stride, const void* offset) const;
+        /**
+         * @brief Links a region of a ring buffer to this VAO.
+         * @param ring    The ring buffer to link.
+         * @param layout  The layout location of the vertex attribute.
+         * @param size    The number of components per vertex attribute.
+         * @param type    The data type of each component in the vertex attribute.
+         * @param stride  The byte offset between consecutive generic vertex attributes.
+         * @param offset  The offset of the first component in the ring buffer, usually the offset of an allocation.
+         */
+        void LinkAttrib(const mk::Graphics::RingBuffer& ring, GLuint layout, GLuint size, GLenum type, GLsizeiptr stride, const void* offset) const;
+        /**
+         * @brief Sets the rate at which a vertex attribute of this VAO advances during instanced rendering.
+         * The VAO must be bound.
+         * @param layout  The layout location of the vertex attribute.
+         * @param divisor The number of instances that pass between updates of the attribute (0 advances per vertex).
+         */
+        void SetAttribDivisor(GLuint layout, GLuint divisor) const
+        { glVertexAttribDivisor(layout, divisor); }
 
       private:
         GLuint ID {0};
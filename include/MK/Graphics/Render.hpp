@@ -1,7 +1,12 @@
 #ifndef MK_RENDER_HPP
 #define MK_RENDER_HPP
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "Objects.hpp"
+#include "RingBuffer.hpp"
 #include "Shapes.hpp"
 #include "Camera.hpp"
 
@@ -13,6 +18,109 @@ namespace mk
    */
   namespace Render
   {
+    /**
+     * @brief Per-instance attributes of a rectangle drawn through the instanced path.
+     * The model transform is a 2D affine transform in the layout of a GLSL mat2x3.
+     */
+    struct InstanceData
+    {
+      GLfloat model[6];
+      GLfloat fillColor[3];
+    };
+
+    /**
+     * @brief A pre-transformed vertex written by the batch renderer.
+     */
+    struct BatchVertex
+    {
+      GLfloat position[3];
+      GLfloat color[3];
+    };
+
+    class Renderer;
+
+    /**
+     * @brief The payload of a draw deferred through a render queue.
+     */
+    struct DrawCommand
+    {
+      mk::Render::Renderer* renderer {nullptr};
+      GLuint  VAO        {0};
+      GLsizei indexCount {0};
+      mk::Space::Affine2D model;
+      mk::Space::Vec3     fillColor;
+    };
+
+    /**
+     * @brief A queue of deferred draws replayed in the order of their 64-bit sort keys.
+     * Sorting groups draws by layer, then shader, then VAO, so program and VAO switches are minimized.
+     */
+    class RenderQueue
+    {
+      public:
+        /**
+         * @brief Builds a sort key.
+         * The key packs, from the most significant bits: the layer (8 bits), the shader ID (12 bits),
+         * the VAO ID (12 bits) and the depth (32 bits).
+         * @param layer The render layer.
+         * @param shader The ID of the shader program.
+         * @param VAO The ID of the vertex array object.
+         * @param depth The depth, used to order draws that share a layer, shader and VAO.
+         * Renderers use the submission order, so such draws keep the order they were rendered in.
+         * @return The sort key.
+         */
+        static std::uint64_t makeKey(const std::uint8_t layer, const GLuint shader, const GLuint VAO, const std::uint32_t depth)
+        {
+          return
+            static_cast<std::uint64_t>(layer) << 56 |
+            static_cast<std::uint64_t>(shader & 0xFFFu) << 44 |
+            static_cast<std::uint64_t>(VAO & 0xFFFu) << 32 |
+            static_cast<std::uint64_t>(depth);
+        }
+
+        /**
+         * @brief Retrieves the number of queued draws.
+         * @return The number of queued draws.
+         */
+        std::size_t getSize() const
+        { return commands.size(); }
+
+        /**
+         * @brief Queues a draw.
+         * @param key The sort key of the draw.
+         * @param command The payload of the draw.
+         */
+        void submit(const std::uint64_t key, const mk::Render::DrawCommand& command)
+        {
+          entries.push_back({key, static_cast<std::uint32_t>(commands.size())});
+          commands.push_back(command);
+        }
+        /**
+         * @brief Radix-sorts the queued draws by key, replays them and empties the queue.
+         */
+        void flush();
+
+      private:
+        /**
+         * @brief A sort key paired with the index of its payload.
+         */
+        struct Entry
+        {
+          std::uint64_t key;
+          std::uint32_t index;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<Entry> sortBuffer;
+        std::vector<mk::Render::DrawCommand> commands;
+
+        /**
+         * @brief Sorts the entries by key with a stable least-significant-digit radix sort.
+         * Passes over bytes that are identical for every key are skipped.
+         */
+        void _sort();
+    };
+
     /**
      * @brief A class responsible for rendering shapes using a specified shader.
      */
@@ -21,11 +129,20 @@ namespace mk
       public:
         /**
          * @brief Constructs a Renderer object with the specified shader.
+         * The handles of the per-shape uniforms are resolved once here.
          * @param shader The shader to be used for rendering.
          */
         Renderer(mk::Graphics::Shader& shader, mk::Camera& camera)
-        : shader(shader), camera(camera)
+        : shader(shader), camera(camera),
+          modelUniform(shader.getUniform<mk::Space::Affine2D>("model")),
+          fillColorUniform(shader.getUniform<mk::Space::Vec3>("fillColor")),
+          instancedUniform(shader.getUniform<int>("instanced"))
         {}
+        /**
+         * @brief Destructor for Renderer object.
+         * Releases the shared unit quad if the instanced path was used.
+         */
+        ~Renderer();
 
         /**
          * @brief Retrieves the camera used by the renderer.
@@ -33,22 +150,231 @@ namespace mk
          */
         mk::Camera& getCamera() const
         { return camera; }
+        /**
+         * @brief Checks if the renderer draws rectangles through the instanced path.
+         * @return True if instancing is enabled, false otherwise.
+         */
+        bool getInstanced() const
+        { return instanced; }
+        /**
+         * @brief Retrieves the render queue the renderer defers its draws to.
+         * @return A pointer to the render queue, or nullptr if draws are immediate.
+         */
+        mk::Render::RenderQueue* getQueue() const
+        { return queue; }
+        /**
+         * @brief Retrieves the factor shapes are interpolated by between their previous and current states.
+         * @return The interpolation factor.
+         */
+        float getInterpolation() const
+        { return interpolation; }
+        /**
+         * @brief Retrieves the name under which the GPU profiler times the blocks started by use.
+         * @return The pass name.
+         */
+        const char* getPassName() const
+        { return passName; }
+
+        /**
+         * @brief Enables or disables the instanced path.
+         * While enabled, rendered rectangles are collected and drawn together by flush.
+         * Disabling it flushes the collected rectangles.
+         * @param instanced The new instancing state.
+         */
+        void setInstanced(const bool instanced)
+        {
+          if (!instanced)
+            flush();
+          this->instanced = instanced;
+        }
+        /**
+         * @brief Sets the render queue the renderer defers its draws to.
+         * Several renderers may share a queue, so their draws are sorted together.
+         * @param queue A pointer to the render queue, or nullptr to draw immediately.
+         */
+        void setQueue(mk::Render::RenderQueue* queue)
+        {
+          flush();
+          this->queue = queue;
+        }
+        /**
+         * @brief Sets the factor shapes are interpolated by between their previous and current states.
+         * Only shapes that saved a previous state are interpolated, see Shape::savePreviousState.
+         * @param interpolation The interpolation factor, usually Loop::getAlpha, or 1 to render the current states.
+         */
+        void setInterpolation(const float interpolation)
+        { this->interpolation = interpolation; }
+        /**
+         * @brief Sets the name under which the GPU profiler times the blocks started by use.
+         * @param passName The new pass name. Only the pointer is stored, so it is usually a string literal.
+         */
+        void setPassName(const char* passName)
+        { this->passName = passName; }
 
         /**
          * @brief Uses the shader for rendering.
          * This function sets the current shader to be used for rendering,
          * updates the camera matrix, and applies the camera matrix to the shader.
+         * It also starts a GPU profiler pass lasting until the next pass.
          */
         void use();
         /**
          * @brief Renders a shape using the specified shader.
+         * With a render queue set, the draw is deferred to the queue. Otherwise, in instanced mode,
+         * rectangles are queued until the next flush instead of being drawn immediately.
          * @param shape The shape to be rendered.
          */
-        void render(const mk::Shapes::Shape& shape) const;
+        void render(const mk::Shapes::Shape& shape);
+        /**
+         * @brief Draws every queued rectangle with a single instanced draw call and flushes the render queue.
+         * Called automatically by Window::display for renderers added to the window.
+         * The camera is applied again, as the shared uniform buffer holds the camera of the last renderer used.
+         */
+        void flush();
+        /**
+         * @brief Replays a draw deferred through a render queue with the camera of the renderer.
+         * @param command The payload of the draw.
+         */
+        void draw(const mk::Render::DrawCommand& command);
 
       private:
         mk::Graphics::Shader& shader;
         mk::Camera& camera;
+
+        mk::Graphics::Uniform<mk::Space::Affine2D> modelUniform;
+        mk::Graphics::Uniform<mk::Space::Vec3> fillColorUniform;
+        mk::Graphics::Uniform<int>             instancedUniform;
+
+        bool instanced {false};
+        mk::Render::RenderQueue* queue {nullptr};
+        float interpolation {1.f};
+        const char* passName {"Renderer"};
+        std::vector<mk::Render::InstanceData> instances;
+
+        std::unique_ptr<mk::Graphics::VAO> instanceVAO;
+        std::unique_ptr<mk::Graphics::RingBuffer> instanceRing;
+
+        /**
+         * @brief Links the shared unit quad and creates the per-instance ring buffer on first use.
+         */
+        void _initializeInstancing();
+    };
+
+    /**
+     * @brief A class that collects shapes submitted during a frame and draws them in as few draw calls as possible.
+     * Shapes are transformed on the CPU into a streamed vertex buffer with per-vertex colors,
+     * so a batch is only split when the shader changes.
+     */
+    class BatchRenderer
+    {
+      public:
+        /**
+         * @brief Constructs a BatchRenderer object with the specified shader and camera.
+         * The shader is expected to read a position from location 0 and a color from location 1 (see batch.vert).
+         * @param shader The shader to be used for rendering.
+         * @param camera The camera to be used for rendering.
+         */
+        BatchRenderer(mk::Graphics::Shader& shader, mk::Camera& camera)
+        : shader(&shader), camera(camera)
+        {}
+
+        /**
+         * @brief Retrieves the camera used by the batch renderer.
+         * @return A reference to the camera.
+         */
+        mk::Camera& getCamera() const
+        { return camera; }
+        /**
+         * @brief Retrieves the shader used by the batch renderer.
+         * @return A reference to the shader.
+         */
+        mk::Graphics::Shader& getShader() const
+        { return *shader; }
+        /**
+         * @brief Retrieves the number of draw calls issued since the last call to use.
+         * @return The number of draw calls.
+         */
+        unsigned int getDrawCalls() const
+        { return drawCalls; }
+        /**
+         * @brief Retrieves the factor shapes are interpolated by between their previous and current states.
+         * @return The interpolation factor.
+         */
+        float getInterpolation() const
+        { return interpolation; }
+        /**
+         * @brief Retrieves the name under which the GPU profiler times the blocks started by use.
+         * @return The pass name.
+         */
+        const char* getPassName() const
+        { return passName; }
+
+        /**
+         * @brief Changes the shader used for subsequent submissions.
+         * The shapes submitted so far are flushed with the previous shader, then the new one is used with the camera.
+         * @param shader The new shader.
+         */
+        void setShader(mk::Graphics::Shader& shader);
+        /**
+         * @brief Sets the factor shapes are interpolated by between their previous and current states.
+         * Only shapes that saved a previous state are interpolated, see Shape::savePreviousState.
+         * @param interpolation The interpolation factor, usually Loop::getAlpha, or 1 to submit the current states.
+         */
+        void setInterpolation(const float interpolation)
+        { this->interpolation = interpolation; }
+        /**
+         * @brief Sets the name under which the GPU profiler times the blocks started by use.
+         * @param passName The new pass name. Only the pointer is stored, so it is usually a string literal.
+         */
+        void setPassName(const char* passName)
+        { this->passName = passName; }
+
+        /**
+         * @brief Uses the shader for rendering and resets the draw call count.
+         * This function sets the current shader, updates the camera matrix, and applies it to the shader.
+         * It also starts a GPU profiler pass lasting until the next pass.
+         */
+        void use();
+        /**
+         * @brief Appends the vertices of a shape to the current batch.
+         * @param shape The shape to be rendered.
+         */
+        void submit(const mk::Shapes::Shape& shape);
+        /**
+         * @brief Appends quads whose corners were already transformed, for example by mk::Space::computeQuadCorners.
+         * @param corners Four corners per quad, in the order written by mk::Space::computeQuadCorners.
+         * @param colors One color per quad.
+         * @param count The number of quads.
+         */
+        void submit(const mk::Space::Vec2* corners, const mk::Space::Vec3* colors, const std::size_t count);
+        /**
+         * @brief Draws the current batch with a single draw call and empties it.
+         */
+        void flush();
+
+      private:
+        mk::Graphics::Shader* shader;
+        mk::Camera& camera;
+
+        std::vector<mk::Render::BatchVertex> vertices;
+        std::size_t  quadCapacity  {0};
+        unsigned int drawCalls     {0};
+        float        interpolation {1.f};
+        const char*  passName      {"BatchRenderer"};
+
+        std::unique_ptr<mk::Graphics::VAO> VAO;
+        std::unique_ptr<mk::Graphics::EBO> EBO;
+        std::unique_ptr<mk::Graphics::RingBuffer> ring;
+
+        /**
+         * @brief Creates the vertex array, the quad index buffer and the vertex ring buffer on first use.
+         */
+        void _initialize();
+        /**
+         * @brief Grows the shared quad index pattern so it covers the specified number of quads.
+         * @param quadCount The number of quads that have to be indexable.
+         */
+        void _reserveQuads(const std::size_t quadCount);
     };
   }
 }
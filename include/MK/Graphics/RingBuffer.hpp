@@ -0,0 +1,122 @@
+#ifndef MK_RING_BUFFER_HPP
+#define MK_RING_BUFFER_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+namespace mk
+{
+  namespace Graphics
+  {
+    /**
+     * @brief A buffer object split into regions that are written by the CPU while the GPU reads the previous ones.
+     * When GL_ARB_buffer_storage is available, the whole buffer is persistently and coherently mapped.
+     * Otherwise each allocation is mapped with glMapBufferRange using unsynchronized, invalidating writes.
+     * A fence guards every region, so a region is only reused once the GPU is done with it.
+     * The first allocation of every frame of the current context moves to the next region.
+     */
+    class RingBuffer
+    {
+      public:
+        /**
+         * @brief A sub-allocation of the current region.
+         */
+        struct Allocation
+        {
+          void*      data   {nullptr};
+          GLintptr   offset {0};
+          GLsizeiptr size   {0};
+        };
+
+        /**
+         * @brief Constructs a RingBuffer object.
+         * @param regionSize The size of each region in bytes.
+         * @param regionCount The number of regions, usually the number of frames in flight.
+         */
+        RingBuffer(const GLsizeiptr regionSize, const unsigned int regionCount = 3);
+        /**
+         * @brief Destructor for RingBuffer object.
+         */
+        ~RingBuffer()
+        { Delete(); }
+        RingBuffer(const mk::Graphics::RingBuffer&) = delete;
+        mk::Graphics::RingBuffer& operator=(const mk::Graphics::RingBuffer&) = delete;
+
+        /**
+         * @brief Retrieves the ID of the buffer object.
+         * The ID changes when the ring grows, so attribute pointers must be linked after allocating.
+         * @return The ID of the buffer object.
+         */
+        GLuint getID() const
+        { return ID; }
+        /**
+         * @brief Retrieves the size of each region.
+         * @return The size of each region in bytes.
+         */
+        GLsizeiptr getRegionSize() const
+        { return regionSize; }
+        /**
+         * @brief Checks if the buffer is persistently mapped.
+         * @return True if GL_ARB_buffer_storage is used, false if the glMapBufferRange fallback is used.
+         */
+        bool isPersistent() const
+        { return persistent; }
+
+        /**
+         * @brief Binds the buffer object to GL_ARRAY_BUFFER.
+         */
+        void Bind() const;
+        /**
+         * @brief Deletes the buffer object and its fences.
+         */
+        void Delete();
+
+        /**
+         * @brief Sub-allocates memory from the current region.
+         * Moves to the next region on the first allocation of a frame or if the current one is full,
+         * and grows the ring if the request exceeds a region.
+         * The memory must be written before calling commit.
+         * @param size The size of the allocation in bytes.
+         * @param alignment The alignment of the allocation's offset in bytes.
+         * @return The allocation.
+         */
+        mk::Graphics::RingBuffer::Allocation allocate(const GLsizeiptr size, const GLsizeiptr alignment = 16);
+        /**
+         * @brief Makes the written allocation visible to the GPU.
+         * Must be called before drawing from the allocation. This unmaps the allocation in the fallback path.
+         */
+        void commit();
+        /**
+         * @brief Fences the current region and moves to the next one, waiting until the GPU has released it.
+         * Called by allocate once per frame, after the draws that read the current region have been issued.
+         */
+        void nextRegion();
+
+      private:
+        GLuint     ID          {0};
+        GLsizeiptr regionSize  {0};
+        unsigned int regionCount {0};
+        bool       persistent  {false};
+        bool       mapped      {false};
+        char*      persistentData {nullptr};
+
+        unsigned int  region {0};
+        GLsizeiptr    head   {0};
+        std::uint64_t frame  {0};  ///< The frame of the state cache the current region was allocated in.
+        std::vector<GLsync> fences;
+
+        /**
+         * @brief Creates and, if possible, persistently maps the data store.
+         */
+        void _create();
+        /**
+         * @brief Blocks until the fence of a region is signaled and deletes it.
+         * @param index The index of the region.
+         */
+        void _wait(const unsigned int index);
+    };
+  }
+}
+
+#endif // MK_RING_BUFFER_HPP
@@ -1,10 +1,16 @@
 #ifndef MK_SHAPES_HPP
 #define MK_SHAPES_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include <MK/Core/Constants.hpp>
 #include <MK/Core/Space.hpp>
 #include <MK/Core/Debug.hpp>
 
 #include "Color.hpp"
+#include "Geometry.hpp"
 #include "Objects.hpp"
 
 namespace mk
@@ -37,6 +43,86 @@ namespace mk
       {}
     } BoundRect;
 
+    /**
+     * @brief Represents a rectangle rotated around its center.
+     */
+    struct OrientedBox
+    {
+      mk::Space::Vec2 center;
+      mk::Space::Vec2 halfExtents;  ///< Half the size of the box along each of its axes.
+      mk::Space::Vec2 axes[2];      ///< The unit directions of the width and height of the box.
+
+      /**
+       * @brief Retrieves the smallest axis-aligned rectangle containing the box.
+       * @return The boundary rectangle of the box.
+       */
+      mk::Shapes::BoundRect getBounds() const;
+    };
+
+    /**
+     * @brief Represents a convex polygon stored inline, for collision detection.
+     * Vertices may be given in either winding order, and the edge normals always point outwards.
+     */
+    class ConvexPolygon
+    {
+      public:
+        /**
+         * @brief Constructs a ConvexPolygon object from its vertices.
+         * Vertices past mk::Constants::POLYGON_MAX_VERTICES are dropped with an error message.
+         * @param vertices The vertices of the polygon, in order around its edge.
+         * @param count The number of vertices.
+         */
+        ConvexPolygon(const mk::Space::Vec2* vertices, const int count);
+        /**
+         * @brief Constructs a ConvexPolygon object from the corners of an oriented box.
+         * @param box The oriented box.
+         */
+        explicit ConvexPolygon(const mk::Shapes::OrientedBox& box);
+
+        /**
+         * @brief Retrieves the number of vertices of the polygon.
+         * @return The number of vertices.
+         */
+        int getCount() const
+        { return count; }
+        /**
+         * @brief Retrieves a vertex of the polygon.
+         * @param index The index of the vertex.
+         * @return The vertex.
+         */
+        const mk::Space::Vec2& getVertex(const int index) const
+        { return vertices[index]; }
+        /**
+         * @brief Retrieves the outward unit normal of the edge from a vertex to the next one.
+         * @param index The index of the first vertex of the edge.
+         * @return The normal of the edge.
+         */
+        const mk::Space::Vec2& getNormal(const int index) const
+        { return normals[index]; }
+        /**
+         * @brief Retrieves the smallest axis-aligned rectangle containing the polygon.
+         * @return The boundary rectangle of the polygon.
+         */
+        mk::Shapes::BoundRect getBounds() const;
+
+        /**
+         * @brief Creates a copy of the polygon with every vertex transformed, such as from model to world space.
+         * @param transform The transform to apply.
+         * @return The transformed polygon.
+         */
+        mk::Shapes::ConvexPolygon transformed(const mk::Space::Affine2D& transform) const;
+
+      private:
+        std::array<mk::Space::Vec2, mk::Constants::POLYGON_MAX_VERTICES> vertices;
+        std::array<mk::Space::Vec2, mk::Constants::POLYGON_MAX_VERTICES> normals;
+        int                                                              count {0};
+
+        /**
+         * @brief Computes the outward edge normals from the vertices.
+         */
+        void _computeNormals();
+    };
+
     /**
      * @brief Base class for geometric shapes.
      */
@@ -44,82 +130,28 @@ namespace mk
     {
       public:
         /**
-         * @brief Constructs a Shape object with a position and index count.
+         * @brief Constructs a Shape object with a position, a shared primitive and a size.
+         * Construction only references the primitive and does not allocate or call OpenGL.
          * @param position The position of the shape.
-         * @param indexCount The number of indices in the shape.
+         * @param primitive The shared geometry the shape is drawn with.
+         * @param size The size the primitive is scaled to by the model transform.
          */
-        Shape(const mk::Space::Vec2& position, const unsigned int indexCount)
-        : position(position), indexCount(indexCount)
-        {}
+        Shape(const mk::Space::Vec2& position, const mk::Graphics::Primitive primitive, const mk::Space::Vec2& size)
+        : position(position), size(size), primitive(primitive), previousPosition(position)
+        { mk::Graphics::GeometryRegistry::retain(primitive); }
         /**
          * @brief Virtual destructor.
-         * Deletes associated vertex array, vertex buffer, and element buffer objects.
+         * Releases the reference to the shared primitive.
          */
         virtual ~Shape()
-        {
-          if (VAO != nullptr) VAO->Delete();
-          if (VBO != nullptr) VBO->Delete();
-          if (EBO != nullptr) EBO->Delete();
-        }
-        /**
-         * @brief Move constructor.
-         * Moves resources from the source shape.
-         */
-        Shape(mk::Shapes::Shape&& other) noexcept
-        : position(other.position), scale(other.scale), rotation(other.rotation), indexCount(other.indexCount), fillColor(other.fillColor), VAO(other.VAO), VBO(other.VBO), EBO(other.EBO)
-        {
-          other.VAO = nullptr;
-          other.VBO = nullptr;
-          other.EBO = nullptr;
-          other.indexCount = 0;
-          other.position = {0.f};
-          other.scale = {0.f};
-          other.rotation = 0.f;
-          other.fillColor = mk::Color::White;
-        }
+        { mk::Graphics::GeometryRegistry::release(primitive); }
         /**
          * @brief Copy constructor.
-         * Copies resources from the source shape.
+         * Copies the source shape and references the same primitive.
          */
         Shape(const mk::Shapes::Shape& other) noexcept
-        : position(other.position), scale(other.scale), rotation(other.rotation), indexCount(other.indexCount), fillColor(other.fillColor)
-        {
-          if (other.VAO != nullptr) VAO = other.VAO;
-          if (other.VBO != nullptr) VBO = other.VBO;
-          if (other.EBO != nullptr) EBO = other.EBO;
-        }
-        /**
-         * @brief Move assignment operator.
-         * Moves resources from the source shape.
-         */
-        mk::Shapes::Shape& operator=(mk::Shapes::Shape&& other) noexcept
-        {
-          if (this != &other)
-          {
-            if (VAO != nullptr) VAO->Delete();
-            if (VBO != nullptr) VBO->Delete();
-            if (EBO != nullptr) EBO->Delete();
-
-            if (other.VAO != nullptr) VAO = other.VAO;
-            if (other.VBO != nullptr) VBO = other.VBO;
-            if (other.EBO != nullptr) EBO = other.EBO;
-            position = other.position;
-            scale = other.scale;
-            rotation = other.rotation;
-            indexCount = other.indexCount;
-            fillColor = other.fillColor;
-
-            other.VAO = nullptr;
-            other.VBO = nullptr;
-            other.EBO = nullptr;
-            other.indexCount = 0;
-            other.position = {0.f};
-            other.scale = {0.f};
-            other.rotation = 0.f;
-            other.fillColor = mk::Color::White;
-          }
-          return *this;
-        }
+        : position(other.position), scale(other.scale), rotation(other.rotation), size(other.size), primitive(other.primitive), fillColor(other.fillColor), layer(other.layer), previousPosition(other.previousPosition), previousScale(other.previousScale), previousRotation(other.previousRotation), isInterpolated(other.isInterpolated), transform(other.transform), isTransformDirty(other.isTransformDirty), axes(other.axes), isAxesDirty(other.isAxesDirty)
+        { mk::Graphics::GeometryRegistry::retain(primitive); }
         /**
          * @brief Copy assignment operator.
          * @param other The shape to copy.
@@ -129,19 +161,24 @@ namespace mk
         {
           if (this != &other)
           {
-            if (VAO != nullptr) VAO->Delete();
-            if (VBO != nullptr) VBO->Delete();
-            if (EBO != nullptr) EBO->Delete();
-
-            if (other.VAO != nullptr) VAO = other.VAO;
-            if (other.VBO != nullptr) VBO = other.VBO;
-            if (other.EBO != nullptr) EBO = other.EBO;
+            mk::Graphics::GeometryRegistry::retain(other.primitive);
+            mk::Graphics::GeometryRegistry::release(primitive);
 
             position = other.position;
             scale = other.scale;
             rotation = other.rotation;
-            indexCount = other.indexCount;
+            size = other.size;
+            primitive = other.primitive;
             fillColor = other.fillColor;
+            layer = other.layer;
+            previousPosition = other.previousPosition;
+            previousScale = other.previousScale;
+            previousRotation = other.previousRotation;
+            isInterpolated = other.isInterpolated;
+            transform = other.transform;
+            isTransformDirty = other.isTransformDirty;
+            axes = other.axes;
+            isAxesDirty = other.isAxesDirty;
           }
           return *this;
         }
@@ -164,119 +201,302 @@ namespace mk
          */
         float getRotation() const
         { return rotation; }
+        /**
+         * @brief Retrieves the model transform of the shape.
+         * The transform is cached and only rebuilt after the position, scale or rotation changed.
+         * @return The model transform of the shape.
+         */
+        const mk::Space::Affine2D& getTransform() const
+        {
+          if (isTransformDirty)
+            updateTransform();
+          return transform;
+        }
+        /**
+         * @brief Retrieves the model transform of the shape between its previous and current states.
+         * Shapes updated at a fixed rate are rendered with the alpha of the loop, so their motion looks smooth at
+         * any render rate. Interpolation is opt-in: shapes that never saved a previous state, and shapes that
+         * did not change since it, use the cached transform. The setters teleport the shape.
+         * @param alpha The interpolation factor, from 0 (previous state) to 1 (current state).
+         * @return The interpolated model transform of the shape.
+         */
+        mk::Space::Affine2D getTransform(const float alpha) const;
+        /**
+         * @brief Checks if the cached model transform is out of date.
+         * @return True if the transform has to be rebuilt, false otherwise.
+         */
+        bool getIsTransformDirty() const
+        { return isTransformDirty; }
+        /**
+         * @brief Checks if the shape is interpolated between its previous and current states.
+         * @return True if a previous state was saved, false otherwise.
+         */
+        bool getIsInterpolated() const
+        { return isInterpolated; }
+        /**
+         * @brief Retrieves the unit directions of the width and height of the shape.
+         * The axes are cached and only recomputed after the rotation changed.
+         * @return The rotated X and Y axes of the shape.
+         */
+        const std::array<mk::Space::Vec2, 2>& getAxes() const
+        {
+          if (isAxesDirty)
+            updateAxes();
+          return axes;
+        }
+        /**
+         * @brief Retrieves the rotated and scaled box covered by the shape.
+         * @return The oriented box of the shape.
+         */
+        mk::Shapes::OrientedBox getOrientedBox() const
+        {
+          const std::array<mk::Space::Vec2, 2>& shapeAxes = getAxes();
+          return {position + size / 2.f, {std::abs(size.x * scale.x) / 2.f, std::abs(size.y * scale.y) / 2.f}, {shapeAxes[0], shapeAxes[1]}};
+        }
 
         /**
-         * @brief Retrieves the boundary rectangle of the shape.
+         * @brief Retrieves the position of the shape when its previous state was saved.
+         * @return The previous position of the shape.
+         */
+        mk::Space::Vec2 getPreviousPosition() const
+        { return previousPosition; }
+        /**
+         * @brief Retrieves the scale of the shape when its previous state was saved.
+         * @return The previous scale of the shape.
+         */
+        mk::Space::Vec2 getPreviousScale() const
+        { return previousScale; }
+        /**
+         * @brief Retrieves the rotation angle of the shape when its previous state was saved.
+         * @return The previous rotation angle of the shape.
+         */
+        float getPreviousRotation() const
+        { return previousRotation; }
+
+        /**
+         * @brief Retrieves the boundary rectangle of the shape, including its scale and rotation.
          * @return The boundary rectangle of the shape.
          */
         virtual mk::Shapes::BoundRect getBounds() const = 0;
+        /**
+         * @brief Retrieves the size the shape's primitive is scaled to.
+         * @return The size of the shape.
+         */
+        mk::Space::Vec2 getSize() const
+        { return size; }
+        /**
+         * @brief Retrieves the shared primitive the shape is drawn with.
+         * @return The primitive of the shape.
+         */
+        mk::Graphics::Primitive getPrimitive() const
+        { return primitive; }
         /**
          * @brief Retrieves the number of indices in the shape.
          * @return The number of indices.
          */
         unsigned int getIndexCount() const
-        { return indexCount; }
+        { return mk::Graphics::GeometryRegistry::getIndexCount(primitive); }
         /**
          * @brief Retrieves the vertex array object of the shape.
+         * The object is shared by every shape with the same primitive.
          * @return A pointer to the vertex array object.
          */
         const mk::Graphics::VAO* getVAO() const
-        { return VAO; }
+        { return mk::Graphics::GeometryRegistry::get(primitive).VAO; }
         /**
          * @brief Retrieves the vertex buffer object of the shape.
+         * The object is shared by every shape with the same primitive.
          * @return A pointer to the vertex buffer object.
          */
         const mk::Graphics::VBO* getVBO() const
-        { return VBO; }
+        { return mk::Graphics::GeometryRegistry::get(primitive).VBO; }
         /**
          * @brief Retrieves the element buffer object of the shape.
+         * The object is shared by every shape with the same primitive.
          * @return A pointer to the element buffer object.
          */
         const mk::Graphics::EBO* getEBO() const
-        { return EBO; }
+        { return mk::Graphics::GeometryRegistry::get(primitive).EBO; }
         /**
          * @brief Retrieves the fill color of the shape.
          * @return The fill color of the shape.
          */
         mk::Color::RGBA getFillColor() const
         { return fillColor; }
+        /**
+         * @brief Retrieves the render layer of the shape.
+         * @return The render layer of the shape.
+         */
+        std::uint8_t getLayer() const
+        { return layer; }
 
         /**
          * @brief Sets the position of the shape.
+         * The previous position is set as well, so the jump is not interpolated. Use move for motion.
          * @param position The new position of the shape.
          */
         void setPosition(const mk::Space::Vec2& position)
-        { this->position = position; }
+        {
+          this->position = position;
+          previousPosition = position;
+          isTransformDirty = true;
+        }
         /**
          * @brief Sets the scale of the shape.
+         * The previous scale is set as well, so the change is not interpolated.
          * @param scale The new scale of the shape.
          */
         void setScale(const mk::Space::Vec2& scale)
-        { this->scale = scale; }
+        {
+          this->scale = scale;
+          previousScale = scale;
+          isTransformDirty = true;
+        }
         /**
          * @brief Sets the scale of the shape along the X-axis.
+         * The previous scale is set as well, so the change is not interpolated.
          * @param scaleX The new scale along the X-axis.
          */
         void setScaleX(const float scaleX)
-        { this->scale.x = scaleX; }
+        {
+          this->scale.x = scaleX;
+          previousScale.x = scaleX;
+          isTransformDirty = true;
+        }
         /**
          * @brief Sets the scale of the shape along the Y-axis.
+         * The previous scale is set as well, so the change is not interpolated.
          * @param scaleY The new scale along the Y-axis.
          */
         void setScaleY(const float scaleY)
-        { this->scale.y = scaleY; }
+        {
+          this->scale.y = scaleY;
+          previousScale.y = scaleY;
+          isTransformDirty = true;
+        }
         /**
          * @brief Sets the rotation angle of the shape.
+         * The previous rotation is set as well, so the change is not interpolated. Use rotate for motion.
          * @param degrees The new rotation angle in degrees.
          */
         void setRotation(const float degrees)
-        { this->rotation = std::remainderf(degrees, 360.f);; }
+        {
+          this->rotation = std::remainderf(degrees, 360.f);
+          previousRotation = this->rotation;
+          isTransformDirty = true;
+          isAxesDirty = true;
+        }
         /**
          * @brief Sets the fill color of the shape.
          * @param fillColor The new fill color of the shape.
          */
         void setFillColor(const mk::Color::RGBA& fillColor)
         { this->fillColor = fillColor; }
+        /**
+         * @brief Sets the render layer of the shape.
+         * Layers are drawn in ascending order by deferred renderers.
+         * @param layer The new render layer of the shape.
+         */
+        void setLayer(const std::uint8_t layer)
+        { this->layer = layer; }
 
         /**
          * @brief Moves the shape along the X-axis by the specified amount.
          * @param amount The amount by which to move the shape along the X-axis.
          */
         void moveX(const float amount)
-        { position.x += amount; }
+        {
+          position.x += amount;
+          isTransformDirty = true;
+        }
         /**
          * @brief Moves the shape along the Y-axis by the specified amount.
          * @param amount The amount by which to move the shape along the Y-axis.
          */
         void moveY(const float amount)
-        { position.y += amount; }
+        {
+          position.y += amount;
+          isTransformDirty = true;
+        }
         /**
          * @brief Moves the shape by the specified amount in both the X and Y axes.
          * @param amount The amount by which to move the shape in both axes.
          */
         void move(const mk::Space::Vec2& amount)
-        { position += amount; }
+        {
+          position += amount;
+          isTransformDirty = true;
+        }
         /**
          * @brief Rotates the shape by the specified angle.
          * @param degrees The angle in degrees by which to rotate the shape.
          */
         void rotate(const float degrees)
-        { rotation = std::remainderf(rotation - degrees, 360.f); }
+        {
+          rotation = std::remainderf(rotation - degrees, 360.f);
+          isTransformDirty = true;
+          isAxesDirty = true;
+        }
+
+        /**
+         * @brief Saves the position, scale and rotation of the shape as its previous state.
+         * Call it at the start of every fixed update step of shapes moved with move and rotate. The first call
+         * opts the shape into interpolation; other shapes are always rendered at their current state. The setters
+         * already save the state they set, so placing a shape never blends it from where it was.
+         */
+        void savePreviousState()
+        {
+          previousPosition = position;
+          previousScale = scale;
+          previousRotation = rotation;
+          isInterpolated = true;
+        }
+
+        /**
+         * @brief Rebuilds the cached model transform and clears the dirty flag.
+         */
+        void updateTransform() const;
+        /**
+         * @brief Recomputes the cached axes from the rotation and clears their dirty flag.
+         */
+        void updateAxes() const;
 
       protected:
         mk::Space::Vec2 position {0.f};
         mk::Space::Vec2 scale    {1.f};
         float           rotation {0.f};
+        mk::Space::Vec2 size     {0.f};
 
-        unsigned int indexCount {0};
-
-        mk::Graphics::VAO* VAO {nullptr};
-        mk::Graphics::VBO* VBO {nullptr};
-        mk::Graphics::EBO* EBO {nullptr};
+        mk::Graphics::Primitive primitive {mk::Graphics::Primitive::Quad};
 
         mk::Color::RGBA fillColor {mk::Color::White};
+        std::uint8_t    layer     {0};
+
+        mk::Space::Vec2 previousPosition {0.f};
+        mk::Space::Vec2 previousScale    {1.f};
+        float           previousRotation {0.f};
+        bool            isInterpolated   {false};
+
+        mutable mk::Space::Affine2D            transform;
+        mutable bool                           isTransformDirty {true};
+        mutable std::array<mk::Space::Vec2, 2> axes;
+        mutable bool                           isAxesDirty      {true};
     };
 
+    /**
+     * @brief Rebuilds the cached transforms of the shapes that changed since their last update.
+     * Running this once per frame keeps the transform math in one loop ahead of rendering,
+     * and shapes that did not move are skipped.
+     * @param shapes A range of shapes.
+     */
+    template<typename Range>
+    void updateTransforms(const Range& shapes)
+    {
+      for (const auto& shape : shapes)
+        if (shape.getIsTransformDirty())
+          shape.updateTransform();
+    }
+
     /**
      * @brief Class representing a rectangle shape.
      */
@@ -289,30 +509,29 @@ namespace mk
          * @param width The width of the rectangle.
          * @param height The height of the rectangle.
          */
-        Rectangle(const mk::Space::Vec2& position, const float width, const float height);
+        Rectangle(const mk::Space::Vec2& position, const float width, const float height)
+        : mk::Shapes::Shape(position, mk::Graphics::Primitive::Quad, {width, height})
+        {}
 
         /**
          * @brief Retrieves the boundary rectangle of the rectangle shape.
+         * The rectangle is scaled and rotated around its center, so the bounds only match its position and
+         * size while it is neither scaled nor rotated.
          * @return The boundary rectangle of the rectangle shape.
          */
-        mk::Shapes::BoundRect getBounds() const override
-        { return BoundRect(position.x, position.y, width, height); }
+        mk::Shapes::BoundRect getBounds() const override;
         /**
          * @brief Retrieves the width of the rectangle.
          * @return The width of the rectangle.
          */
         float getWidth() const
-        { return width; }
+        { return size.x; }
         /**
          * @brief Retrieves the height of the rectangle.
          * @return The height of the rectangle.
          */
         float getHeight() const
-        { return height; }
-
-      private:
-        float width {0.f};
-        float height {0.f};
+        { return size.y; }
     };
 
     /**
@@ -321,6 +540,15 @@ namespace mk
      */
     namespace Collision
     {
+      /**
+       * @brief A pair of broadphase proxies whose bounds overlap, with the lower proxy ID first.
+       */
+      struct Pair
+      {
+        int proxyOne;
+        int proxyTwo;
+      };
+
       /**
        * @brief Checks if two Axis-Aligned Bounding Boxes (AABBs) intersect.
        * @param rectOne The bounding box of the first object.
@@ -337,6 +565,146 @@ namespace mk
           rectOne.y + rectOne.height > rectTwo.y
         );
       }
+
+      /**
+       * @brief The contact between two intersecting convex shapes.
+       */
+      struct Manifold
+      {
+        mk::Space::Vec2 normal     {0.f};  ///< The unit direction from the first shape to the second one along which they separate.
+        float           depth      {0.f};  ///< The distance along the normal that separates the shapes.
+        mk::Space::Vec2 points[2];         ///< The contact points, halfway between the two surfaces.
+        int             pointCount {0};
+      };
+
+      /**
+       * @brief The earliest contact of a box moving along a motion vector.
+       */
+      struct SweepHit
+      {
+        float           time   {1.f};  ///< The fraction of the motion travelled before the boxes touch, from 0 to 1.
+        mk::Space::Vec2 normal {0.f};  ///< The normal of the face that was hit, or zero if the boxes already overlapped.
+        int             proxy  {-1};   ///< The proxy that was hit, for sweeps through a broadphase.
+      };
+
+      /**
+       * @brief Finds when a moving Axis-Aligned Bounding Box (AABB) first touches a static one.
+       * Unlike testing the end position, the whole motion is checked, so fast boxes cannot tunnel through thin ones.
+       * Moving by motion * time leaves the boxes touching without overlapping.
+       * @param rect The bounding box at the start of the motion.
+       * @param motion The distance the box moves.
+       * @param target The static bounding box.
+       * @param hit The time of impact and the normal of the face that was hit, only written on a hit.
+       * @return True if the box hits the target during the motion or already overlaps it, false otherwise.
+       */
+      bool SweptAABB(const mk::Shapes::BoundRect& rect, const mk::Space::Vec2& motion, const mk::Shapes::BoundRect& target, mk::Shapes::Collision::SweepHit& hit);
+      /**
+       * @brief Finds when a moving shape first touches a static one, using their bounds.
+       * @param shape The moving shape, at the start of the motion.
+       * @param motion The distance the shape moves.
+       * @param target The static shape.
+       * @param hit The time of impact and the normal of the face that was hit, only written on a hit.
+       * @return True if the shape hits the target during the motion or already overlaps it, false otherwise.
+       */
+      inline bool SweptAABB(const mk::Shapes::Shape& shape, const mk::Space::Vec2& motion, const mk::Shapes::Shape& target, mk::Shapes::Collision::SweepHit& hit)
+      { return SweptAABB(shape.getBounds(), motion, target.getBounds(), hit); }
+      /**
+       * @brief Computes the region covered by a bounding box along its whole motion.
+       * Querying a broadphase with it finds every candidate for a sweep.
+       * @param rect The bounding box at the start of the motion.
+       * @param motion The distance the box moves.
+       * @return The bounds of the swept box.
+       */
+      inline mk::Shapes::BoundRect sweptBounds(const mk::Shapes::BoundRect& rect, const mk::Space::Vec2& motion)
+      {
+        return BoundRect(
+          std::min(rect.x, rect.x + motion.x),
+          std::min(rect.y, rect.y + motion.y),
+          rect.width + std::abs(motion.x),
+          rect.height + std::abs(motion.y)
+        );
+      }
+
+      /**
+       * @brief Checks if two Oriented Bounding Boxes (OBBs) intersect with the separating axis theorem.
+       * @param boxOne The first box.
+       * @param boxTwo The second box.
+       * @return True if the OBBs intersect, false otherwise.
+       */
+      bool OBB(const mk::Shapes::OrientedBox& boxOne, const mk::Shapes::OrientedBox& boxTwo);
+      /**
+       * @brief Checks if the rotated boxes of two shapes intersect.
+       * Shapes are usually tested after a broadphase or an AABB check has found them as candidates.
+       * @param shapeOne The first shape.
+       * @param shapeTwo The second shape.
+       * @return True if the shapes intersect, false otherwise.
+       */
+      inline bool OBB(const mk::Shapes::Shape& shapeOne, const mk::Shapes::Shape& shapeTwo)
+      { return OBB(shapeOne.getOrientedBox(), shapeTwo.getOrientedBox()); }
+      /**
+       * @brief Finds the contact between two convex polygons with the separating axis theorem.
+       * The edge with the smallest penetration becomes the reference face, and the contact points are found by
+       * clipping the most opposed edge of the other polygon against it.
+       * @param polygonOne The first polygon.
+       * @param polygonTwo The second polygon.
+       * @param manifold The contact, only written if the polygons intersect.
+       * @return True if the polygons intersect, false otherwise.
+       */
+      bool SAT(const mk::Shapes::ConvexPolygon& polygonOne, const mk::Shapes::ConvexPolygon& polygonTwo, mk::Shapes::Collision::Manifold& manifold);
+      /**
+       * @brief Finds the contact between two oriented boxes, rejecting separated boxes before building the manifold.
+       * @param boxOne The first box.
+       * @param boxTwo The second box.
+       * @param manifold The contact, only written if the boxes intersect.
+       * @return True if the boxes intersect, false otherwise.
+       */
+      bool SAT(const mk::Shapes::OrientedBox& boxOne, const mk::Shapes::OrientedBox& boxTwo, mk::Shapes::Collision::Manifold& manifold);
+      /**
+       * @brief Finds the contact between the rotated boxes of two shapes.
+       * @param shapeOne The first shape.
+       * @param shapeTwo The second shape.
+       * @param manifold The contact, only written if the shapes intersect.
+       * @return True if the shapes intersect, false otherwise.
+       */
+      inline bool SAT(const mk::Shapes::Shape& shapeOne, const mk::Shapes::Shape& shapeTwo, mk::Shapes::Collision::Manifold& manifold)
+      { return SAT(shapeOne.getOrientedBox(), shapeTwo.getOrientedBox(), manifold); }
+
+      /**
+       * @brief A batch of rectangles stored as separate arrays, for the batched AABB tests.
+       * Every array holds one value per rectangle.
+       */
+      struct BoundArrays
+      {
+        const float* x      {nullptr};
+        const float* y      {nullptr};
+        const float* width  {nullptr};
+        const float* height {nullptr};
+        std::size_t  count  {0};
+      };
+
+      /**
+       * @brief Checks a bounding box against a batch of bounding boxes.
+       * With AVX the kernel tests eight rectangles per iteration, and four with SSE2. A rectangle of zero size
+       * tests a point, which is how mouse picking uses it.
+       * @param rect The bounding box to test.
+       * @param rects The batch of bounding boxes.
+       * @param hits The bitmask receiving one bit per rectangle of the batch, set if it intersects rect. Rectangle i
+       * maps to bit i % 8 of byte i / 8, so the buffer must hold (count + 7) / 8 bytes.
+       * @return The number of intersecting rectangles.
+       */
+      std::size_t AABB(const mk::Shapes::BoundRect& rect, const mk::Shapes::Collision::BoundArrays& rects, std::uint8_t* hits);
+
+      namespace Scalar
+      {
+        /**
+         * @brief Checks a bounding box against a batch of bounding boxes, one rectangle at a time.
+         * @param rect The bounding box to test.
+         * @param rects The batch of bounding boxes.
+         * @param hits The bitmask receiving one bit per rectangle of the batch, laid out as in the SIMD version.
+         * @return The number of intersecting rectangles.
+         */
+        std::size_t AABB(const mk::Shapes::BoundRect& rect, const mk::Shapes::Collision::BoundArrays& rects, std::uint8_t* hits);
+      }
     }
   }
 }
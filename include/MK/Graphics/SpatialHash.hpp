@@ -0,0 +1,179 @@
+#ifndef MK_SPATIAL_HASH_HPP
+#define MK_SPATIAL_HASH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <MK/Core/Constants.hpp>
+#include <MK/Core/Space.hpp>
+
+#include "Shapes.hpp"
+
+namespace mk
+{
+  namespace Shapes
+  {
+    namespace Collision
+    {
+      /**
+       * @brief A uniform grid collision broadphase, rebuilt every frame.
+       * Proxies are binned into square cells stored in a flat open-addressing hash table, and the proxies of
+       * every cell are packed into a single array. Clearing the hash keeps all of its storage, so rebuilding it
+       * every frame does not allocate. It works best when most objects are about the size of a cell or smaller.
+       */
+      class SpatialHash
+      {
+        public:
+          /**
+           * @brief Constructs an empty SpatialHash object.
+           * @param cellSize The width and height of the cells, in world units.
+           */
+          SpatialHash(const float cellSize = mk::Constants::SPATIAL_HASH_CELL_SIZE)
+          : cellSize(cellSize), inverseCellSize(1.f / cellSize)
+          {}
+
+          /**
+           * @brief Retrieves the size of the cells.
+           * @return The width and height of the cells.
+           */
+          float getCellSize() const
+          { return cellSize; }
+          /**
+           * @brief Retrieves the number of proxies in the hash.
+           * @return The number of proxies.
+           */
+          int getProxyCount() const
+          { return static_cast<int>(proxies.size()); }
+          /**
+           * @brief Retrieves the number of non-empty cells, building the hash if needed.
+           * @return The number of cells holding at least one proxy.
+           */
+          int getCellCount()
+          {
+            _build();
+            return static_cast<int>(occupiedSlots.size());
+          }
+          /**
+           * @brief Retrieves the user data of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The user data passed when the proxy was inserted.
+           */
+          void* getUserData(const int proxy) const
+          { return proxies[proxy].userData; }
+          /**
+           * @brief Retrieves the bounds of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The bounds passed when the proxy was inserted.
+           */
+          mk::Shapes::BoundRect getBounds(const int proxy) const
+          {
+            const Proxy& entry = proxies[proxy];
+            return {entry.lower.x, entry.lower.y, entry.upper.x - entry.lower.x, entry.upper.y - entry.lower.y};
+          }
+
+          /**
+           * @brief Inserts a proxy. Proxy IDs are assigned in insertion order, starting from zero after every clear.
+           * @param bounds The bounds of the proxy.
+           * @param userData A pointer returned by getUserData, usually the owner of the bounds.
+           * @return The ID of the new proxy.
+           */
+          int insert(const mk::Shapes::BoundRect& bounds, void* userData = nullptr);
+          /**
+           * @brief Inserts a proxy for a shape, using the shape as the user data.
+           * @param shape The shape to insert.
+           * @return The ID of the new proxy.
+           */
+          int insert(mk::Shapes::Shape& shape)
+          { return insert(shape.getBounds(), &shape); }
+          /**
+           * @brief Removes every proxy while keeping the memory of the table and cells for the next frame.
+           */
+          void clear();
+
+          /**
+           * @brief Finds the proxies whose bounds overlap a region, building the hash if needed.
+           * @param region The region to test.
+           * @param proxies The vector receiving the IDs of the overlapping proxies. It is cleared first.
+           */
+          void query(const mk::Shapes::BoundRect& region, std::vector<int>& proxies);
+          /**
+           * @brief Finds every pair of proxies whose bounds overlap, building the hash if needed.
+           * Each pair is reported once, with the lower proxy ID first, even if the proxies share several cells.
+           * @param pairs The vector receiving the pairs. It is cleared first.
+           */
+          void queryPairs(std::vector<mk::Shapes::Collision::Pair>& pairs);
+          /**
+           * @brief Finds the first proxy hit by a bounding box moving along a motion vector, building the hash if needed.
+           * Only the proxies in the cells covered by the motion are tested.
+           * @param bounds The bounding box at the start of the motion.
+           * @param motion The distance the box moves.
+           * @param hit The earliest hit and the proxy it hit, if any.
+           * @param ignoredProxy A proxy to skip, usually the one of the moving box, or -1.
+           * @return True if the box hits a proxy, false otherwise.
+           */
+          bool sweep(const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& motion, mk::Shapes::Collision::SweepHit& hit, const int ignoredProxy = -1);
+
+        private:
+          /**
+           * @brief A proxy and the range of cells it covers.
+           */
+          struct Proxy
+          {
+            mk::Space::Vec2 lower;
+            mk::Space::Vec2 upper;
+            void*           userData;
+            int             cellMinX;
+            int             cellMinY;
+            int             cellMaxX;
+            int             cellMaxY;
+          };
+          /**
+           * @brief A slot of the hash table. Slots whose stamp differs from the current one are empty.
+           */
+          struct Slot
+          {
+            std::uint64_t key    {0u};
+            std::uint32_t stamp  {0u};
+            int           offset {0};  ///< The index of the first proxy of the cell in cellProxies.
+            int           count  {0};
+          };
+
+          std::vector<Proxy> proxies;
+          std::vector<Slot>  table;
+          std::vector<int>   cellProxies;
+          std::vector<int>   occupiedSlots;
+          std::vector<int>   sweepCandidates;
+          std::size_t        coveredCells    {0u};  ///< The number of (proxy, cell) entries, an upper bound on the number of cells.
+          std::uint32_t      stamp           {0u};
+          bool               isBuilt         {true};
+          float              cellSize        {0.f};
+          float              inverseCellSize {0.f};
+
+          /**
+           * @brief Converts a world coordinate to a cell coordinate.
+           * @param value The world coordinate.
+           * @return The index of the cell containing the coordinate along its axis.
+           */
+          int _cellCoordinate(const float value) const;
+          /**
+           * @brief Finds the slot of a cell.
+           * @param key The packed coordinates of the cell.
+           * @return The index of the slot, or -1 if the cell is empty.
+           */
+          int _findSlot(const std::uint64_t key) const;
+          /**
+           * @brief Finds the slot of a cell, claiming an empty slot if the cell is not in the table yet.
+           * @param key The packed coordinates of the cell.
+           * @return The index of the slot.
+           */
+          int _findOrAddSlot(const std::uint64_t key);
+          /**
+           * @brief Counts the proxies of every cell and packs them into cellProxies, if proxies were inserted since the last build.
+           */
+          void _build();
+      };
+    }
+  }
+}
+
+#endif // MK_SPATIAL_HASH_HPP
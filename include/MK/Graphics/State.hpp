@@ -0,0 +1,306 @@
+#ifndef MK_STATE_HPP
+#define MK_STATE_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+
+#include "Stats.hpp"
+
+namespace mk
+{
+  namespace Graphics
+  {
+    /**
+     * @brief A per-context tracker of the OpenGL state touched by the engine.
+     * The object wrappers go through the current cache, which only issues a GL call when the
+     * requested state differs from the recorded one.
+     */
+    class StateCache
+    {
+      public:
+        /**
+         * @brief Retrieves the state cache of the current context.
+         * If no window has made its context current, a fallback cache is returned.
+         * @return A reference to the current state cache.
+         */
+        static mk::Graphics::StateCache& current();
+        /**
+         * @brief Sets the state cache of the current context.
+         * @param cache A pointer to the new current cache, or nullptr to use the fallback cache.
+         */
+        static void setCurrent(mk::Graphics::StateCache* cache);
+
+        /**
+         * @brief Retrieves the number of GL calls issued through the cache.
+         * @return The number of issued calls.
+         */
+        std::uint64_t getIssuedCalls() const
+        { return issuedCalls; }
+        /**
+         * @brief Retrieves the number of GL calls skipped because the state was already set.
+         * @return The number of elided calls.
+         */
+        std::uint64_t getElidedCalls() const
+        { return elidedCalls; }
+        /**
+         * @brief Resets the issued and elided call counters.
+         */
+        void resetCounters()
+        {
+          issuedCalls = 0;
+          elidedCalls = 0;
+        }
+        /**
+         * @brief Retrieves the index of the current frame of the context.
+         * Streamed buffers compare it with the frame of their last allocation to move to a new region once per frame.
+         * @return The number of frames started.
+         */
+        std::uint64_t getFrame() const
+        { return frame; }
+        /**
+         * @brief Starts a new frame of the context.
+         */
+        void beginFrame()
+        { frame++; }
+        /**
+         * @brief Retrieves the render statistics counted since the last reset.
+         * @return A constant reference to the statistics.
+         */
+        const mk::Render::Stats& getStats() const
+        { return stats; }
+        /**
+         * @brief Resets the per-frame render statistics, keeping the live object counts.
+         */
+        void resetStats()
+        { stats.resetFrame(); }
+
+        /**
+         * @brief Records a draw call.
+         * @param indexCount The number of indices drawn per instance.
+         * @param instanceCount The number of instances drawn.
+         */
+        void recordDraw(const GLsizei indexCount, const GLsizei instanceCount = 1)
+        {
+          const std::uint64_t indices = static_cast<std::uint64_t>(indexCount) * static_cast<std::uint64_t>(instanceCount);
+          stats.drawCalls++;
+          stats.indices += indices;
+          stats.triangles += indices / 3u;
+        }
+        /**
+         * @brief Records the upload of a uniform value.
+         */
+        void recordUniformUpload()
+        { stats.uniformUploads++; }
+        /**
+         * @brief Records data written to a buffer object.
+         * @param size The size of the data in bytes.
+         */
+        void recordUpload(const GLsizeiptr size)
+        {
+          stats.bufferUploads++;
+          stats.uploadedBytes += static_cast<std::uint64_t>(size);
+        }
+
+        /**
+         * @brief Marks every tracked state as unknown.
+         * Call this after changing GL state without going through the cache.
+         */
+        void invalidate()
+        {
+          program = UNKNOWN;
+          vertexArray = UNKNOWN;
+          arrayBuffer = UNKNOWN;
+          elementBuffer = UNKNOWN;
+          framebuffer = UNKNOWN;
+          polygonMode = UNKNOWN;
+          viewport[0] = viewport[1] = viewport[2] = viewport[3] = -1;
+        }
+
+        /**
+         * @brief Makes a shader program current.
+         * @param ID The ID of the shader program.
+         */
+        void useProgram(const GLuint ID)
+        {
+          if (_isCurrent(program, ID))
+            return;
+          stats.programSwitches++;
+          glUseProgram(ID);
+        }
+        /**
+         * @brief Binds a vertex array object.
+         * The element buffer binding is part of the VAO, so it becomes unknown when the VAO changes.
+         * @param ID The ID of the vertex array object.
+         */
+        void bindVertexArray(const GLuint ID)
+        {
+          if (_isCurrent(vertexArray, ID))
+            return;
+          stats.vertexArrayBinds++;
+          glBindVertexArray(ID);
+          elementBuffer = UNKNOWN;
+        }
+        /**
+         * @brief Binds a buffer object to a target.
+         * Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are tracked; other targets are always issued.
+         * @param target The target to bind the buffer to.
+         * @param ID The ID of the buffer object.
+         */
+        void bindBuffer(const GLenum target, const GLuint ID)
+        {
+          if (target == GL_ARRAY_BUFFER && _isCurrent(arrayBuffer, ID))
+            return;
+          if (target == GL_ELEMENT_ARRAY_BUFFER && _isCurrent(elementBuffer, ID))
+            return;
+          if (target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER)
+            issuedCalls++;
+          glBindBuffer(target, ID);
+        }
+        /**
+         * @brief Binds a framebuffer object as both the draw and the read framebuffer.
+         * @param ID The ID of the framebuffer object, or 0 for the default framebuffer.
+         */
+        void bindFramebuffer(const GLuint ID)
+        {
+          if (_isCurrent(framebuffer, ID))
+            return;
+          glBindFramebuffer(GL_FRAMEBUFFER, ID);
+        }
+        /**
+         * @brief Sets the polygon rasterization mode for front and back faces.
+         * @param mode The polygon mode (GL_POINT, GL_LINE or GL_FILL).
+         */
+        void setPolygonMode(const GLenum mode)
+        {
+          if (_isCurrent(polygonMode, mode))
+            return;
+          glPolygonMode(GL_FRONT_AND_BACK, mode);
+        }
+        /**
+         * @brief Sets the viewport.
+         * @param x The x-coordinate of the lower left corner.
+         * @param y The y-coordinate of the lower left corner.
+         * @param width The width of the viewport.
+         * @param height The height of the viewport.
+         */
+        void setViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+        {
+          if (viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height)
+          {
+            elidedCalls++;
+            return;
+          }
+          viewport[0] = x;
+          viewport[1] = y;
+          viewport[2] = width;
+          viewport[3] = height;
+          issuedCalls++;
+          glViewport(x, y, width, height);
+        }
+
+        /**
+         * @brief Records the creation of a shader program.
+         */
+        void trackProgram()
+        { stats.programs++; }
+        /**
+         * @brief Records the creation of a vertex array object.
+         */
+        void trackVertexArray()
+        { stats.vertexArrays++; }
+        /**
+         * @brief Records the creation of a buffer object.
+         */
+        void trackBuffer()
+        { stats.buffers++; }
+        /**
+         * @brief Records the creation of a framebuffer object.
+         */
+        void trackFramebuffer()
+        { stats.framebuffers++; }
+
+        /**
+         * @brief Records the deletion of a shader program.
+         * @param ID The ID of the deleted program.
+         */
+        void forgetProgram(const GLuint ID)
+        {
+          stats.programs--;
+          if (program == ID)
+            program = UNKNOWN;
+        }
+        /**
+         * @brief Records the deletion of a vertex array object, which OpenGL unbinds if it is bound.
+         * @param ID The ID of the deleted vertex array object.
+         */
+        void forgetVertexArray(const GLuint ID)
+        {
+          stats.vertexArrays--;
+          if (vertexArray == ID)
+          {
+            vertexArray = 0;
+            elementBuffer = UNKNOWN;
+          }
+        }
+        /**
+         * @brief Records the deletion of a buffer object, which OpenGL unbinds from the tracked targets.
+         * @param ID The ID of the deleted buffer object.
+         */
+        void forgetBuffer(const GLuint ID)
+        {
+          stats.buffers--;
+          if (arrayBuffer == ID)
+            arrayBuffer = 0;
+          if (elementBuffer == ID)
+            elementBuffer = 0;
+        }
+        /**
+         * @brief Records the deletion of a framebuffer object, which OpenGL unbinds if it is bound.
+         * @param ID The ID of the deleted framebuffer object.
+         */
+        void forgetFramebuffer(const GLuint ID)
+        {
+          stats.framebuffers--;
+          if (framebuffer == ID)
+            framebuffer = 0;
+        }
+
+      private:
+        static constexpr GLuint UNKNOWN {0xFFFFFFFFu};
+
+        GLuint program       {0};
+        GLuint vertexArray   {0};
+        GLuint arrayBuffer   {0};
+        GLuint elementBuffer {0};
+        GLuint framebuffer   {0};
+        GLenum polygonMode   {GL_FILL};
+        GLint  viewport[4]   {-1, -1, -1, -1};
+
+        std::uint64_t issuedCalls {0};
+        std::uint64_t elidedCalls {0};
+        std::uint64_t frame       {0};
+
+        mk::Render::Stats stats;
+
+        /**
+         * @brief Compares a tracked state with a requested value and records the value.
+         * @param state The tracked state.
+         * @param value The requested value.
+         * @return True if the state already had the value and the call can be elided, false otherwise.
+         */
+        bool _isCurrent(GLuint& state, const GLuint value)
+        {
+          if (state == value)
+          {
+            elidedCalls++;
+            return true;
+          }
+          state = value;
+          issuedCalls++;
+          return false;
+        }
+    };
+  }
+}
+
+#endif // MK_STATE_HPP
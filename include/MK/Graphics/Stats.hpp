@@ -0,0 +1,56 @@
+#ifndef MK_STATS_HPP
+#define MK_STATS_HPP
+
+#include <cstdint>
+
+namespace mk
+{
+  namespace Render
+  {
+    /**
+     * @brief Counters of the work submitted to OpenGL.
+     * The state cache of every context fills them as the engine issues calls, and the window takes a
+     * snapshot of them at the end of every frame before resetting the per-frame counters.
+     */
+    struct Stats
+    {
+      std::uint64_t drawCalls        {0u};
+      std::uint64_t triangles        {0u};
+      std::uint64_t indices          {0u};
+      std::uint64_t programSwitches  {0u};  ///< The glUseProgram calls left after redundant ones are elided.
+      std::uint64_t vertexArrayBinds {0u};  ///< The glBindVertexArray calls left after redundant ones are elided.
+      std::uint64_t uniformUploads   {0u};  ///< The glUniform calls left after unchanged values are skipped.
+      std::uint64_t bufferUploads    {0u};
+      std::uint64_t uploadedBytes    {0u};  ///< The bytes written to buffers, including streamed ring buffer allocations.
+
+      int buffers      {0};  ///< The live buffer objects. Object counts are not reset between frames.
+      int vertexArrays {0};  ///< The live vertex array objects.
+      int programs     {0};  ///< The live shader programs.
+      int framebuffers {0};  ///< The live framebuffer objects.
+
+      /**
+       * @brief Retrieves the number of live OpenGL objects of every kind.
+       * @return The number of live objects.
+       */
+      int getLiveObjects() const
+      { return buffers + vertexArrays + programs + framebuffers; }
+
+      /**
+       * @brief Clears the per-frame counters, keeping the object counts.
+       */
+      void resetFrame()
+      {
+        drawCalls = 0u;
+        triangles = 0u;
+        indices = 0u;
+        programSwitches = 0u;
+        vertexArrayBinds = 0u;
+        uniformUploads = 0u;
+        bufferUploads = 0u;
+        uploadedBytes = 0u;
+      }
+    };
+  }
+}
+
+#endif // MK_STATS_HPP
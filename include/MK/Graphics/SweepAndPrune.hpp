@@ -0,0 +1,149 @@
+#ifndef MK_SWEEP_AND_PRUNE_HPP
+#define MK_SWEEP_AND_PRUNE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <MK/Core/Space.hpp>
+
+#include "Shapes.hpp"
+
+namespace mk
+{
+  namespace Shapes
+  {
+    namespace Collision
+    {
+      /**
+       * @brief A sort and sweep collision broadphase along the x axis that reports pairs as they start and stop overlapping.
+       * The sorted interval endpoints are kept between updates and re-sorted with an insertion sort. Objects only move
+       * slightly between frames, so the order barely changes and an update runs in near-linear time.
+       */
+      class SweepAndPrune
+      {
+        public:
+          /**
+           * @brief Retrieves the number of proxies.
+           * @return The number of proxies.
+           */
+          int getProxyCount() const
+          { return proxyCount; }
+          /**
+           * @brief Retrieves the user data of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The user data passed when the proxy was inserted.
+           */
+          void* getUserData(const int proxy) const
+          { return proxies[proxy].userData; }
+          /**
+           * @brief Retrieves the bounds of a proxy.
+           * @param proxy The ID of the proxy.
+           * @return The bounds last passed to insert or move.
+           */
+          mk::Shapes::BoundRect getBounds(const int proxy) const
+          {
+            const Proxy& entry = proxies[proxy];
+            return {entry.lower.x, entry.lower.y, entry.upper.x - entry.lower.x, entry.upper.y - entry.lower.y};
+          }
+          /**
+           * @brief Retrieves the pairs overlapping as of the last update.
+           * @return The pairs, sorted by their first and then their second proxy ID.
+           */
+          const std::vector<mk::Shapes::Collision::Pair>& getPairs() const
+          { return pairs; }
+          /**
+           * @brief Retrieves the number of endpoint swaps done by the insertion sort of the last update.
+           * @return The number of swaps, which stays close to zero for coherent motion.
+           */
+          std::size_t getSwapCount() const
+          { return swapCount; }
+
+          /**
+           * @brief Inserts a proxy. Its pairs are reported by the next update.
+           * @param bounds The bounds of the proxy.
+           * @param userData A pointer returned by getUserData, usually the owner of the bounds.
+           * @return The ID of the new proxy.
+           */
+          int insert(const mk::Shapes::BoundRect& bounds, void* userData = nullptr);
+          /**
+           * @brief Inserts a proxy for a shape, using the shape as the user data.
+           * @param shape The shape to insert.
+           * @return The ID of the new proxy.
+           */
+          int insert(mk::Shapes::Shape& shape)
+          { return insert(shape.getBounds(), &shape); }
+          /**
+           * @brief Removes a proxy. The end of its pairs is reported by the next update, and its ID is only reused after it.
+           * @param proxy The ID of the proxy.
+           */
+          void remove(const int proxy);
+          /**
+           * @brief Updates the bounds of a proxy. The endpoints are re-sorted by the next update.
+           * @param proxy The ID of the proxy.
+           * @param bounds The new bounds of the proxy.
+           */
+          void move(const int proxy, const mk::Shapes::BoundRect& bounds);
+          /**
+           * @brief Updates the bounds of a proxy from its shape.
+           * @param proxy The ID of the proxy.
+           * @param shape The shape the proxy was inserted for.
+           */
+          void move(const int proxy, const mk::Shapes::Shape& shape)
+          { move(proxy, shape.getBounds()); }
+          /**
+           * @brief Removes every proxy and pair without reporting events.
+           */
+          void clear();
+
+          /**
+           * @brief Re-sorts the endpoints, finds the overlapping pairs and compares them with those of the last update.
+           * @param begun The vector receiving the pairs that started overlapping. It is cleared first.
+           * @param ended The vector receiving the pairs that stopped overlapping or lost a proxy. It is cleared first.
+           */
+          void update(std::vector<mk::Shapes::Collision::Pair>& begun, std::vector<mk::Shapes::Collision::Pair>& ended);
+
+        private:
+          /**
+           * @brief A proxy and its position in the list of intervals open during the sweep.
+           */
+          struct Proxy
+          {
+            mk::Space::Vec2 lower;
+            mk::Space::Vec2 upper;
+            void*           userData    {nullptr};
+            int             activeIndex {-1};
+          };
+          /**
+           * @brief The start or end of the x interval of a proxy.
+           */
+          struct Endpoint
+          {
+            float value;
+            int   proxy;
+            bool  isMin;
+          };
+
+          std::vector<Proxy>                       proxies;
+          std::vector<Endpoint>                    endpoints;
+          std::vector<mk::Shapes::Collision::Pair> pairs;
+          std::vector<mk::Shapes::Collision::Pair> nextPairs;
+          std::vector<int>                         active;
+          std::vector<int>                         freeProxies;
+          std::vector<int>                         removedProxies;  ///< Proxies freed once the next update reports the end of their pairs.
+          std::size_t                              swapCount  {0u};
+          int                                      proxyCount {0};
+
+          /**
+           * @brief Refreshes the endpoint values from the proxies and restores their order with an insertion sort.
+           */
+          void _sortEndpoints();
+          /**
+           * @brief Sweeps the sorted endpoints and collects the overlapping pairs into nextPairs.
+           */
+          void _sweep();
+      };
+    }
+  }
+}
+
+#endif // MK_SWEEP_AND_PRUNE_HPP
@@ -3,10 +3,18 @@
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include <MK/Core/Clock.hpp>
+
 #include "Color.hpp"
+#include "State.hpp"
+#include "Stats.hpp"
+#include "Frame.hpp"
+#include "GPUProfiler.hpp"
 #include "Render.hpp"
 #include "Shapes.hpp"
 
@@ -32,6 +40,11 @@ namespace mk
       Window(const unsigned int width, const unsigned int height, const std::string& title)
       : width(width), height(height), title(title)
       { _initialize(); }
+      /**
+       * @brief Destructor for Window object.
+       * Detaches the window's state cache and frame uniforms if they are the current ones.
+       */
+      ~Window();
 
       /**
        * @brief Gets the width of the window.
@@ -70,23 +83,42 @@ namespace mk
       mk::Color::RGBA getClearColor() const
       { return clearColor; }
       /**
-       * @brief Gets the time elapsed since GLFW was initialized.
-       * @return The time elapsed since GLFW was initialized, in seconds.
+       * @brief Gets the time the window's clock has been running, excluding pauses and including its scale.
+       * @return The elapsed time, in seconds.
        */
-      float getTime() const
-      { return static_cast<float>(glfwGetTime()); }
+      double getTime() const
+      { return clock.getElapsed(); }
       /**
        * @brief Gets the time taken to render the last frame.
        * @return The time taken to render the last frame, in seconds.
        */
       float getDeltaTime() const
-      { return deltaTime; }
+      { return static_cast<float>(clock.getDelta()); }
       /**
-       * @brief Gets the frames per second (FPS) of the rendering.
-       * @return The frames per second (FPS) of the rendering. If delta time is zero, returns zero.
+       * @brief Gets the frames per second (FPS) of the rendering, averaged over the recent frames.
+       * @return The smoothed frames per second (FPS) of the rendering, or zero before the first frame.
        */
       float getFPS() const
-      { return deltaTime > 0.f ? 1.f / deltaTime : 0.f; }
+      { return static_cast<float>(clock.getFPS()); }
+      /**
+       * @brief Gets the clock measuring the frames of the window.
+       * The clock can be paused or scaled, and gives frame time percentiles.
+       * @return A reference to the clock.
+       */
+      mk::Core::Clock& getClock()
+      { return clock; }
+      /**
+       * @brief Gets the clock measuring the frames of the window.
+       * @return A constant reference to the clock.
+       */
+      const mk::Core::Clock& getClock() const
+      { return clock; }
+      /**
+       * @brief Checks if the window renders offscreen.
+       * @return True if the window was created in headless mode, false otherwise.
+       */
+      bool getIsHeadless() const
+      { return isHeadless; }
       /**
        * @brief Checks if the window is maximized.
        * @return True if the window is maximized, false otherwise.
@@ -99,6 +131,43 @@ namespace mk
        */
       std::vector<mk::Render::Renderer*> getRenderers() const
       { return renderers; }
+      /**
+       * @brief Retrieves the OpenGL state cache of the window's context.
+       * @return A reference to the state cache.
+       */
+      mk::Graphics::StateCache& getStateCache()
+      { return stateCache; }
+      /**
+       * @brief Retrieves the per-frame uniform buffer of the window's context.
+       * @return A reference to the frame uniforms.
+       */
+      mk::Graphics::FrameUniforms& getFrameUniforms()
+      { return frameUniforms; }
+      /**
+       * @brief Retrieves the GPU profiler of the window's context.
+       * Once enabled, it times the clear, every renderer use block and the display of each frame.
+       * @return A reference to the GPU profiler.
+       */
+      mk::Graphics::GPUProfiler& getGPUProfiler()
+      { return gpuProfiler; }
+      /**
+       * @brief Gets the render statistics of the last displayed frame.
+       * The counters of the frame in progress are available from the state cache.
+       * @return A constant reference to the statistics.
+       */
+      const mk::Render::Stats& getStats() const
+      { return frameStats; }
+      /**
+       * @brief Gets the number of frames kept in the render statistics history.
+       * @return The size of the history, or zero if it is disabled.
+       */
+      std::size_t getStatsHistorySize() const
+      { return statsHistory.size(); }
+      /**
+       * @brief Gets the render statistics of the recent frames.
+       * @return The statistics, oldest first.
+       */
+      std::vector<mk::Render::Stats> getStatsHistory() const;
 
       /**
        * @brief Sets the buffer dimensions of the window.
@@ -138,6 +207,11 @@ namespace mk
        */
       void setIsMaximized(const bool isMaximized)
       { this->isMaximized = isMaximized; }
+      /**
+       * @brief Sets the number of frames kept in the render statistics history, clearing it.
+       * @param size The new size of the history, or zero to disable it.
+       */
+      void setStatsHistorySize(const std::size_t size);
 
       /**
        * @brief Checks if the window is open.
@@ -176,6 +250,7 @@ namespace mk
 
       /**
        * @brief Updates the window.
+       * This function polls events, updates the delta time, starts a new frame of the state cache and of the GPU profiler, and uploads the time to the frame uniforms.
        */
       void update();
       /**
@@ -184,8 +259,20 @@ namespace mk
       void clear();
       /**
        * @brief Displays the contents of the window.
+       * The render statistics of the frame are recorded and reset before presenting.
+       * Headless windows have nothing to present, so their commands are only flushed.
        */
       void display();
+      /**
+       * @brief Clears the render statistics of the last frame, the frame in progress and the history.
+       */
+      void resetStats();
+      /**
+       * @brief Reads back the contents of the window's render target.
+       * Headless windows read their offscreen framebuffer and other windows read the back buffer.
+       * @return The pixels as tightly packed RGBA bytes, with the top row first.
+       */
+      std::vector<std::uint8_t> readPixels();
 
     private:
       unsigned int width  {800u};
@@ -195,27 +282,48 @@ namespace mk
       GLFWwindow*     glfwInstance {nullptr};
       mk::Color::RGBA clearColor   {mk::Color::Black};
 
-      float deltaTime {0.f};
-      float lastTime  {static_cast<float>(glfwGetTime())};
+      mk::Core::Clock clock;
 
       float        cachedX      {0.f};
       float        cachedY      {0.f};
       unsigned int cachedWidth  {0u};
       unsigned int cachedHeight {0u};
       bool         isMaximized  {false};
+      bool         isHeadless   {false};
 
       std::vector<mk::Render::Renderer*> renderers;
 
+      mk::Graphics::StateCache    stateCache;
+      mk::Graphics::FrameUniforms frameUniforms;
+      mk::Graphics::GPUProfiler   gpuProfiler;
+
+      mk::Render::Stats              frameStats;
+      std::vector<mk::Render::Stats> statsHistory;
+      std::size_t                    statsHistoryIndex {0u};
+      std::size_t                    statsHistoryCount {0u};
+
+      std::unique_ptr<mk::Graphics::FBO> framebuffer;
+
       /**
        * @brief Initializes the window.
        * This function creates the GLFW window instance.
        */
       void _initialize();
+      /**
+       * @brief Binds the render target of the window.
+       * The offscreen framebuffer of a headless window is created on first use, once GLEW is initialized,
+       * and recreated when the buffer dimensions change.
+       */
+      void _bindRenderTarget();
       /**
        * @brief Updates the time taken to render the last frame.
-       * This function calculates and updates the delta time.
+       * This function ticks the clock, which measures the delta time and records it in the frame time history.
        */
       void _updateDeltaTime();
+      /**
+       * @brief Takes a snapshot of the render statistics of the frame, records it in the history and resets the per-frame counters.
+       */
+      void _recordStats();
   };
 }
 
@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+layout (std140) uniform FrameData
+{
+  mat4 cameraMatrix;
+  vec4 viewport;
+  float time;
+};
+
+out vec3 vertexColor;
+
+void main()
+{
+  vertexColor = aColor;
+  gl_Position = cameraMatrix * vec4(aPos, 1.f);
+}
@@ -1,11 +1,26 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in mat2x3 aModel;
+layout (location = 3) in vec3 aFillColor;
 
-uniform mat4 model;
-uniform mat4 cameraMatrix;
+layout (std140) uniform FrameData
+{
+  mat4 cameraMatrix;
+  vec4 viewport;
+  float time;
+};
+
+uniform mat2x3 model;
+uniform vec3 fillColor;
+uniform bool instanced;
+
+out vec3 vertexColor;
 
 void main()
 {
-  gl_Position = cameraMatrix * model * vec4(aPos, 1.f);
+  mat2x3 transform = instanced ? aModel : model;
+  vec2 position = vec3(aPos.xy, 1.f) * transform;
+  vertexColor = instanced ? aFillColor : fillColor;
+  gl_Position = cameraMatrix * vec4(position, aPos.z, 1.f);
 }
@@ -1,18 +1,56 @@
 #include <MK/Core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-bool mk::Core::initializeGLFW()
+#if !defined(MK_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+  #define MK_SIMD_SSE
+  #if defined(__AVX__)
+    #define MK_SIMD_AVX
+  #endif
+  #include <immintrin.h>
+#endif
+
+bool headlessMode {false};
+
+bool mk::Core::initializeGLFW(const bool headless)
 {
+  headlessMode = headless;
+  if (headless)
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
   bool success = glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, mk::Constants::GL_MAJOR_VER);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, mk::Constants::GL_MINOR_VER);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+  if (headless)
+  {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+  }
   return success;
 }
 
+bool mk::Core::isHeadless()
+{
+  return headlessMode;
+}
+
 bool mk::Core::initializeGLEW()
 {
+  glewExperimental = GL_TRUE;
   GLenum glewErr = glewInit();
+  // Headless contexts are not created through GLX, so GLEW cannot load the GLX extensions.
+  // The OpenGL entry points are loaded regardless.
+  if (glewErr == GLEW_ERROR_NO_GLX_DISPLAY && headlessMode)
+    glewErr = GLEW_OK;
   if (glewErr != GLEW_OK)
   {
     std::cerr << "Failed to initialize GLEW!\n";
@@ -41,8 +79,354 @@ void mk::Core::terminate()
   glfwTerminate();
 }
 
+void mk::Core::Loop::setStepRate(const double stepRate)
+{
+  if (!(stepRate > 0.0))
+  {
+    std::cerr << "ERROR::LOOP::INVALID_STEP_RATE\n" << stepRate << " steps per second, keeping " << (step > 0 ? getStepRate() : mk::Constants::LOOP_STEP_RATE) << std::endl;
+    if (step == 0)
+      step = std::llround(1e9 / mk::Constants::LOOP_STEP_RATE);
+    return;
+  }
+  step = std::max<std::int64_t>(1, std::llround(1e9 / stepRate));
+  accumulator = std::min(accumulator, step - 1);
+  alpha = static_cast<float>(static_cast<double>(accumulator) / static_cast<double>(step));
+}
+
+int mk::Core::Loop::advance(const double frameTime)
+{
+  return advanceNanoseconds(frameTime > 0.0 ? std::llround(frameTime * 1e9) : 0);
+}
+
+int mk::Core::Loop::advanceNanoseconds(const std::int64_t frameTime)
+{
+  if (frameTime > 0)
+    accumulator += frameTime;
+
+  std::int64_t steps = accumulator / step;
+  if (steps > maxSteps)
+  {
+    // Dropping the excess whole steps keeps the fraction of a step that is left, so alpha stays continuous
+    const std::int64_t excess = steps - std::max(maxSteps, 0);
+    droppedTime += excess * step;
+    accumulator -= excess * step;
+    steps -= excess;
+  }
+  accumulator -= steps * step;
+  stepCount += static_cast<std::uint64_t>(steps);
+  alpha = static_cast<float>(static_cast<double>(accumulator) / static_cast<double>(step));
+  return static_cast<int>(steps);
+}
+
+void mk::Core::Loop::reset()
+{
+  accumulator = 0;
+  droppedTime = 0;
+  stepCount = 0u;
+  alpha = 0.f;
+}
+
+mk::Core::Clock::Clock(const std::size_t historySize)
+: history(std::max<std::size_t>(historySize, 1u), 0), start(now()), last(start)
+{}
+
+std::int64_t mk::Core::Clock::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double mk::Core::Clock::getAverageFrameTime() const
+{
+  if (historyCount == 0u)
+    return 0.0;
+  return static_cast<double>(historySum) * 1e-9 / static_cast<double>(historyCount);
+}
+
+double mk::Core::Clock::getFPS() const
+{
+  return historySum > 0 ? static_cast<double>(historyCount) * 1e9 / static_cast<double>(historySum) : 0.0;
+}
+
+double mk::Core::Clock::getPercentile(const double percentile) const
+{
+  if (historyCount == 0u)
+    return 0.0;
+
+  sortedHistory.assign(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(historyCount));
+  const double rank = std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(historyCount));
+  const std::size_t index = std::min(historyCount - 1u, static_cast<std::size_t>(std::max(rank, 1.0)) - 1u);
+  std::nth_element(sortedHistory.begin(), sortedHistory.begin() + static_cast<std::ptrdiff_t>(index), sortedHistory.end());
+  return static_cast<double>(sortedHistory[index]) * 1e-9;
+}
+
+std::vector<std::int64_t> mk::Core::Clock::getHistory() const
+{
+  // Once the history is full, the oldest frame time is the one about to be overwritten
+  std::vector<std::int64_t> ordered;
+  ordered.reserve(historyCount);
+  const std::size_t first = historyCount < history.size() ? 0u : historyIndex;
+  for (std::size_t i = 0; i < historyCount; i++)
+    ordered.push_back(history[(first + i) % history.size()]);
+  return ordered;
+}
+
+std::int64_t mk::Core::Clock::tick()
+{
+  const std::int64_t current = now();
+  rawDelta = current - last;
+  last = current;
+
+  historySum += rawDelta - history[historyIndex];
+  history[historyIndex] = rawDelta;
+  historyIndex = (historyIndex + 1u) % history.size();
+  historyCount = std::min(historyCount + 1u, history.size());
+
+  delta = isPaused ? 0 : std::llround(static_cast<double>(rawDelta) * scale);
+  elapsed += delta;
+  frameCount++;
+  return delta;
+}
+
+void mk::Core::Clock::reset()
+{
+  std::fill(history.begin(), history.end(), 0);
+  historyIndex = 0u;
+  historyCount = 0u;
+  historySum = 0;
+  start = now();
+  last = start;
+  delta = 0;
+  rawDelta = 0;
+  elapsed = 0;
+  frameCount = 0u;
+}
+
+/**
+ * @brief The event ring of a thread. Only its thread writes events, so publishing one is a single release store.
+ */
+struct ProfilerBuffer
+{
+  struct Event
+  {
+    const char*  name;
+    std::int64_t start;
+    std::int64_t end;
+  };
+
+  std::unique_ptr<Event[]>   events {new Event[mk::Constants::PROFILER_BUFFER_SIZE]};
+  std::atomic<std::uint64_t> head   {0u};  ///< The number of events ever written.
+  std::atomic<std::uint64_t> begin  {0u};  ///< The value of head at the last clear.
+  std::uint32_t              thread {0u};
+};
+
+/**
+ * @brief The buffers of every thread that recorded an event. Buffers outlive their threads so their events can still be dumped.
+ */
+struct ProfilerRegistry
+{
+  std::mutex                                   mutex;
+  std::vector<std::unique_ptr<ProfilerBuffer>> buffers;
+};
+
+/**
+ * @brief A recorded event and the thread that recorded it, as collected for a dump.
+ */
+struct ProfilerRecord
+{
+  const char*   name;
+  std::uint32_t thread;
+  std::int64_t  start;
+  std::int64_t  end;
+};
+
+ProfilerRegistry& profilerRegistry()
+{
+  static ProfilerRegistry registry;
+  return registry;
+}
+
+ProfilerBuffer& profilerBuffer()
+{
+  thread_local ProfilerBuffer* buffer {nullptr};
+  if (buffer == nullptr)
+  {
+    ProfilerRegistry& registry = profilerRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.buffers.push_back(std::make_unique<ProfilerBuffer>());
+    buffer = registry.buffers.back().get();
+    buffer->thread = static_cast<std::uint32_t>(registry.buffers.size() - 1u);
+  }
+  return *buffer;
+}
+
+std::uint64_t profilerFirstEvent(const ProfilerBuffer& buffer, const std::uint64_t head)
+{
+  const std::uint64_t capacity = mk::Constants::PROFILER_BUFFER_SIZE;
+  return std::max(buffer.begin.load(std::memory_order_relaxed), head > capacity ? head - capacity : 0u);
+}
+
+std::vector<ProfilerRecord> collectProfilerRecords()
+{
+  std::vector<ProfilerRecord> records;
+  ProfilerRegistry& registry = profilerRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& buffer : registry.buffers)
+  {
+    const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    for (std::uint64_t i = profilerFirstEvent(*buffer, head); i < head; i++)
+    {
+      const ProfilerBuffer::Event& event = buffer->events[i % mk::Constants::PROFILER_BUFFER_SIZE];
+      records.push_back({event.name, buffer->thread, event.start, event.end});
+    }
+  }
+
+  // Parents start no later and end no earlier than their children, so they come first
+  std::sort(records.begin(), records.end(), [](const ProfilerRecord& one, const ProfilerRecord& two)
+  { return one.start != two.start ? one.start < two.start : one.end > two.end; });
+  return records;
+}
+
+void writeProfilerString(std::ofstream& file, const char* text)
+{
+  file << '"';
+  for (; *text != '\0'; text++)
+  {
+    const unsigned char character = static_cast<unsigned char>(*text);
+    if (character == '"' || character == '\\')
+      file << '\\' << *text;
+    else if (character < 0x20u)
+      file << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<unsigned int>(character) << std::dec << std::setfill(' ');
+    else
+      file << *text;
+  }
+  file << '"';
+}
+
+template<typename T>
+void writeProfilerValue(std::ofstream& file, const T value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void mk::Core::Profiler::record(const char* name, const std::int64_t start, const std::int64_t end)
+{
+  ProfilerBuffer& buffer = profilerBuffer();
+  const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  buffer.events[head % mk::Constants::PROFILER_BUFFER_SIZE] = {name, start, end};
+  buffer.head.store(head + 1u, std::memory_order_release);
+}
+
+std::size_t mk::Core::Profiler::getEventCount()
+{
+  std::size_t count = 0u;
+  ProfilerRegistry& registry = profilerRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& buffer : registry.buffers)
+  {
+    const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    count += static_cast<std::size_t>(head - profilerFirstEvent(*buffer, head));
+  }
+  return count;
+}
+
+std::uint64_t mk::Core::Profiler::getDroppedCount()
+{
+  std::uint64_t count = 0u;
+  ProfilerRegistry& registry = profilerRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& buffer : registry.buffers)
+  {
+    const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    count += profilerFirstEvent(*buffer, head) - buffer->begin.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+void mk::Core::Profiler::clear()
+{
+  ProfilerRegistry& registry = profilerRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& buffer : registry.buffers)
+    buffer->begin.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+bool mk::Core::Profiler::writeChromeTrace(const std::string& path)
+{
+  std::ofstream file(path);
+  if (!file.is_open())
+  {
+    std::cerr << "ERROR::PROFILER::FILE_NOT_OPENED\n" << path << std::endl;
+    return false;
+  }
+
+  const std::vector<ProfilerRecord> records = collectProfilerRecords();
+  const std::int64_t origin = records.empty() ? 0 : records.front().start;
+  std::uint32_t threadCount = 0u;
+  for (const ProfilerRecord& record : records)
+    threadCount = std::max(threadCount, record.thread + 1u);
+
+  // Timestamps are in microseconds, relative to the first event
+  file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  file << std::fixed << std::setprecision(3);
+  bool isFirst = true;
+  for (std::uint32_t thread = 0u; thread < threadCount; thread++)
+  {
+    file << (isFirst ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"Thread " << thread << "\"}}";
+    isFirst = false;
+  }
+  for (const ProfilerRecord& record : records)
+  {
+    file << (isFirst ? "\n" : ",\n") << "{\"name\":";
+    writeProfilerString(file, record.name);
+    file << ",\"cat\":\"mk\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.thread
+         << ",\"ts\":" << static_cast<double>(record.start - origin) * 1e-3
+         << ",\"dur\":" << static_cast<double>(record.end - record.start) * 1e-3 << '}';
+    isFirst = false;
+  }
+  file << "\n]}\n";
+  return file.good();
+}
+
+bool mk::Core::Profiler::writeBinary(const std::string& path)
+{
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    std::cerr << "ERROR::PROFILER::FILE_NOT_OPENED\n" << path << std::endl;
+    return false;
+  }
+
+  // Names are stored once, in order of first use
+  const std::vector<ProfilerRecord> records = collectProfilerRecords();
+  std::unordered_map<const char*, std::uint32_t> nameIndices;
+  std::vector<const char*> names;
+  for (const ProfilerRecord& record : records)
+    if (nameIndices.emplace(record.name, static_cast<std::uint32_t>(names.size())).second)
+      names.push_back(record.name);
+
+  file.write("MKPF", 4);
+  writeProfilerValue<std::uint32_t>(file, 1u);
+  writeProfilerValue(file, static_cast<std::uint32_t>(names.size()));
+  for (const char* name : names)
+  {
+    const std::uint32_t length = static_cast<std::uint32_t>(std::strlen(name));
+    writeProfilerValue(file, length);
+    file.write(name, length);
+  }
+  writeProfilerValue(file, static_cast<std::uint64_t>(records.size()));
+  for (const ProfilerRecord& record : records)
+  {
+    writeProfilerValue(file, nameIndices[record.name]);
+    writeProfilerValue(file, record.thread);
+    writeProfilerValue(file, record.start);
+    writeProfilerValue(file, record.end - record.start);
+  }
+  return file.good();
+}
+
 std::string mk::File::getContents(const std::string& path)
 {
+  MK_PROFILE_SCOPE("File::getContents");
   std::ifstream file(path);
   if (!file.is_open())
   {
@@ -119,3 +503,513 @@ mk::Space::Mat4 mk::Space::ortho(const float left, const float right, const floa
 
   return result;
 }
+
+mk::Space::Affine2D mk::Space::Affine2D::fromTransform(const mk::Space::Vec2& translation, const mk::Space::Vec2& scale, const float degrees, const mk::Space::Vec2& origin)
+{
+  const float cosTheta = std::cos(mk::Space::radians(degrees));
+  const float sinTheta = std::sin(mk::Space::radians(degrees));
+
+  const float a = cosTheta * scale.x;
+  const float b = -sinTheta * scale.x;
+  const float c = sinTheta * scale.y;
+  const float d = cosTheta * scale.y;
+  return
+  {
+    a,
+    b,
+    c,
+    d,
+    translation.x - (a * origin.x + c * origin.y),
+    translation.y - (b * origin.x + d * origin.y),
+  };
+}
+
+mk::Space::Affine2D mk::Space::inverse(const mk::Space::Affine2D& affine)
+{
+  const float determinant = affine[0][0] * affine[1][1] - affine[0][1] * affine[1][0];
+  if (determinant == 0.f)
+    return {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+
+  const float inverseDeterminant = 1.f / determinant;
+  const float a = affine[1][1] * inverseDeterminant;
+  const float b = -affine[1][0] * inverseDeterminant;
+  const float c = -affine[0][1] * inverseDeterminant;
+  const float d = affine[0][0] * inverseDeterminant;
+  return
+  {
+    a,
+    b,
+    c,
+    d,
+    -(a * affine[0][2] + c * affine[1][2]),
+    -(b * affine[0][2] + d * affine[1][2]),
+  };
+}
+
+mk::Space::Mat4 mk::Space::toMat4(const mk::Space::Affine2D& affine)
+{
+  mk::Space::Mat4 result {1.f};
+  result[0][0] = affine[0][0];
+  result[0][1] = affine[1][0];
+  result[1][0] = affine[0][1];
+  result[1][1] = affine[1][1];
+  result[3][0] = affine[0][2];
+  result[3][1] = affine[1][2];
+  return result;
+}
+
+mk::Space::Mat4 mk::Space::Scalar::multiply(const mk::Space::Mat4& matOne, const mk::Space::Mat4& matTwo)
+{
+  mk::Space::Mat4 result;
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 4; j++)
+    {
+      float sum = 0.f;
+      for (int k = 0; k < 4; k++)
+        sum += matOne[i][k] * matTwo[k][j];
+      result[i][j] = sum;
+    }
+  return result;
+}
+
+mk::Space::Mat4 mk::Space::Scalar::transpose(const mk::Space::Mat4& mat)
+{
+  mk::Space::Mat4 result;
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 4; j++)
+      result[i][j] = mat[j][i];
+  return result;
+}
+
+mk::Space::Mat4 mk::Space::Scalar::inverse(const mk::Space::Mat4& mat)
+{
+  const float* m = mk::Space::valuePointer(mat);
+  float inv[16];
+
+  inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+  inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+  inv[8]  =  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+  inv[12] = -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+  inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+  inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+  inv[9]  = -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+  inv[13] =  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+  inv[2]  =  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+  inv[6]  = -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+  inv[10] =  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+  inv[14] = -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+  inv[3]  = -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+  inv[7]  =  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+  inv[11] = -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+  inv[15] =  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+  mk::Space::Mat4 result;
+  const float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+  if (determinant == 0.f)
+    return result;
+
+  const float inverseDeterminant = 1.f / determinant;
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 4; j++)
+      result[i][j] = inv[i * 4 + j] * inverseDeterminant;
+  return result;
+}
+
+mk::Space::Vec3 mk::Space::Scalar::transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec3& vec)
+{
+  return
+  {
+    vec.x * mat[0][0] + vec.y * mat[1][0] + vec.z * mat[2][0] + mat[3][0],
+    vec.x * mat[0][1] + vec.y * mat[1][1] + vec.z * mat[2][1] + mat[3][1],
+    vec.x * mat[0][2] + vec.y * mat[1][2] + vec.z * mat[2][2] + mat[3][2],
+  };
+}
+
+mk::Space::Mat4 mk::Space::multiply(const mk::Space::Mat4& matOne, const mk::Space::Mat4& matTwo)
+{
+#if defined(MK_SIMD_AVX)
+  // Two result rows per iteration: each 128-bit lane broadcasts the elements of its own row of matOne
+  const __m256 rowZero  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matTwo[0]));
+  const __m256 rowOne   = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matTwo[1]));
+  const __m256 rowTwo   = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matTwo[2]));
+  const __m256 rowThree = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matTwo[3]));
+
+  mk::Space::Mat4 result;
+  for (int i = 0; i < 4; i += 2)
+  {
+    const __m256 rows = _mm256_loadu_ps(matOne[i]);
+    __m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), rowZero);
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), rowOne));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), rowTwo));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), rowThree));
+    _mm256_storeu_ps(result[i], sum);
+  }
+  return result;
+#elif defined(MK_SIMD_SSE)
+  // Each result row is a linear combination of the rows of matTwo
+  const __m128 rowZero  = _mm_load_ps(matTwo[0]);
+  const __m128 rowOne   = _mm_load_ps(matTwo[1]);
+  const __m128 rowTwo   = _mm_load_ps(matTwo[2]);
+  const __m128 rowThree = _mm_load_ps(matTwo[3]);
+
+  mk::Space::Mat4 result;
+  for (int i = 0; i < 4; i++)
+  {
+    __m128 sum = _mm_mul_ps(_mm_set1_ps(matOne[i][0]), rowZero);
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(matOne[i][1]), rowOne));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(matOne[i][2]), rowTwo));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(matOne[i][3]), rowThree));
+    _mm_store_ps(result[i], sum);
+  }
+  return result;
+#else
+  return mk::Space::Scalar::multiply(matOne, matTwo);
+#endif
+}
+
+mk::Space::Mat4 mk::Space::transpose(const mk::Space::Mat4& mat)
+{
+#if defined(MK_SIMD_SSE)
+  __m128 rowZero  = _mm_load_ps(mat[0]);
+  __m128 rowOne   = _mm_load_ps(mat[1]);
+  __m128 rowTwo   = _mm_load_ps(mat[2]);
+  __m128 rowThree = _mm_load_ps(mat[3]);
+  _MM_TRANSPOSE4_PS(rowZero, rowOne, rowTwo, rowThree);
+
+  mk::Space::Mat4 result;
+  _mm_store_ps(result[0], rowZero);
+  _mm_store_ps(result[1], rowOne);
+  _mm_store_ps(result[2], rowTwo);
+  _mm_store_ps(result[3], rowThree);
+  return result;
+#else
+  return mk::Space::Scalar::transpose(mat);
+#endif
+}
+
+mk::Space::Mat4 mk::Space::inverse(const mk::Space::Mat4& mat)
+{
+#if defined(MK_SIMD_SSE)
+  // Cramer's rule on the transposed matrix, computing the cofactors four at a time
+  const float* source = mk::Space::valuePointer(mat);
+  __m128 temp = _mm_setzero_ps();
+  __m128 rowOne = _mm_setzero_ps();
+  __m128 rowThree = _mm_setzero_ps();
+
+  temp = _mm_loadh_pi(_mm_loadl_pi(temp, reinterpret_cast<const __m64*>(source)), reinterpret_cast<const __m64*>(source + 4));
+  rowOne = _mm_loadh_pi(_mm_loadl_pi(rowOne, reinterpret_cast<const __m64*>(source + 8)), reinterpret_cast<const __m64*>(source + 12));
+  __m128 rowZero = _mm_shuffle_ps(temp, rowOne, 0x88);
+  rowOne = _mm_shuffle_ps(rowOne, temp, 0xDD);
+  temp = _mm_loadh_pi(_mm_loadl_pi(temp, reinterpret_cast<const __m64*>(source + 2)), reinterpret_cast<const __m64*>(source + 6));
+  rowThree = _mm_loadh_pi(_mm_loadl_pi(rowThree, reinterpret_cast<const __m64*>(source + 10)), reinterpret_cast<const __m64*>(source + 14));
+  __m128 rowTwo = _mm_shuffle_ps(temp, rowThree, 0x88);
+  rowThree = _mm_shuffle_ps(rowThree, temp, 0xDD);
+
+  __m128 minorZero, minorOne, minorTwo, minorThree;
+
+  temp = _mm_mul_ps(rowTwo, rowThree);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  minorZero = _mm_mul_ps(rowOne, temp);
+  minorOne = _mm_mul_ps(rowZero, temp);
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorZero = _mm_sub_ps(_mm_mul_ps(rowOne, temp), minorZero);
+  minorOne = _mm_sub_ps(_mm_mul_ps(rowZero, temp), minorOne);
+  minorOne = _mm_shuffle_ps(minorOne, minorOne, 0x4E);
+
+  temp = _mm_mul_ps(rowOne, rowTwo);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  minorZero = _mm_add_ps(_mm_mul_ps(rowThree, temp), minorZero);
+  minorThree = _mm_mul_ps(rowZero, temp);
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorZero = _mm_sub_ps(minorZero, _mm_mul_ps(rowThree, temp));
+  minorThree = _mm_sub_ps(_mm_mul_ps(rowZero, temp), minorThree);
+  minorThree = _mm_shuffle_ps(minorThree, minorThree, 0x4E);
+
+  temp = _mm_mul_ps(_mm_shuffle_ps(rowOne, rowOne, 0x4E), rowThree);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  rowTwo = _mm_shuffle_ps(rowTwo, rowTwo, 0x4E);
+  minorZero = _mm_add_ps(_mm_mul_ps(rowTwo, temp), minorZero);
+  minorTwo = _mm_mul_ps(rowZero, temp);
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorZero = _mm_sub_ps(minorZero, _mm_mul_ps(rowTwo, temp));
+  minorTwo = _mm_sub_ps(_mm_mul_ps(rowZero, temp), minorTwo);
+  minorTwo = _mm_shuffle_ps(minorTwo, minorTwo, 0x4E);
+
+  temp = _mm_mul_ps(rowZero, rowOne);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  minorTwo = _mm_add_ps(_mm_mul_ps(rowThree, temp), minorTwo);
+  minorThree = _mm_sub_ps(_mm_mul_ps(rowTwo, temp), minorThree);
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorTwo = _mm_sub_ps(_mm_mul_ps(rowThree, temp), minorTwo);
+  minorThree = _mm_sub_ps(minorThree, _mm_mul_ps(rowTwo, temp));
+
+  temp = _mm_mul_ps(rowZero, rowThree);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  minorOne = _mm_sub_ps(minorOne, _mm_mul_ps(rowTwo, temp));
+  minorTwo = _mm_add_ps(_mm_mul_ps(rowOne, temp), minorTwo);
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorOne = _mm_add_ps(_mm_mul_ps(rowTwo, temp), minorOne);
+  minorTwo = _mm_sub_ps(minorTwo, _mm_mul_ps(rowOne, temp));
+
+  temp = _mm_mul_ps(rowZero, rowTwo);
+  temp = _mm_shuffle_ps(temp, temp, 0xB1);
+  minorOne = _mm_add_ps(_mm_mul_ps(rowThree, temp), minorOne);
+  minorThree = _mm_sub_ps(minorThree, _mm_mul_ps(rowOne, temp));
+  temp = _mm_shuffle_ps(temp, temp, 0x4E);
+  minorOne = _mm_sub_ps(minorOne, _mm_mul_ps(rowThree, temp));
+  minorThree = _mm_add_ps(_mm_mul_ps(rowOne, temp), minorThree);
+
+  __m128 determinant = _mm_mul_ps(rowZero, minorZero);
+  determinant = _mm_add_ps(_mm_shuffle_ps(determinant, determinant, 0x4E), determinant);
+  determinant = _mm_add_ss(_mm_shuffle_ps(determinant, determinant, 0xB1), determinant);
+
+  mk::Space::Mat4 result;
+  if (_mm_cvtss_f32(determinant) == 0.f)
+    return result;
+
+  const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.f), _mm_shuffle_ps(determinant, determinant, 0x00));
+  _mm_store_ps(result[0], _mm_mul_ps(inverseDeterminant, minorZero));
+  _mm_store_ps(result[1], _mm_mul_ps(inverseDeterminant, minorOne));
+  _mm_store_ps(result[2], _mm_mul_ps(inverseDeterminant, minorTwo));
+  _mm_store_ps(result[3], _mm_mul_ps(inverseDeterminant, minorThree));
+  return result;
+#else
+  return mk::Space::Scalar::inverse(mat);
+#endif
+}
+
+mk::Space::Vec2 mk::Space::transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec2& vec)
+{
+  const mk::Space::Vec3 result = mk::Space::transformPoint(mat, mk::Space::Vec3(vec.x, vec.y, 0.f));
+  return {result.x, result.y};
+}
+
+mk::Space::Vec3 mk::Space::transformPoint(const mk::Space::Mat4& mat, const mk::Space::Vec3& vec)
+{
+#if defined(MK_SIMD_SSE)
+  __m128 sum = _mm_mul_ps(_mm_set1_ps(vec.x), _mm_load_ps(mat[0]));
+  sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(vec.y), _mm_load_ps(mat[1])));
+  sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(vec.z), _mm_load_ps(mat[2])));
+  sum = _mm_add_ps(sum, _mm_load_ps(mat[3]));
+
+  alignas(16) float result[4];
+  _mm_store_ps(result, sum);
+  return {result[0], result[1], result[2]};
+#else
+  return mk::Space::Scalar::transformPoint(mat, vec);
+#endif
+}
+
+const char* mk::Space::getSIMDBackend()
+{
+#if defined(MK_SIMD_AVX)
+  return "AVX";
+#elif defined(MK_SIMD_SSE)
+  return "SSE2";
+#else
+  return "Scalar";
+#endif
+}
+
+// Smallest number of elements worth handing to a separate thread
+constexpr std::size_t TRANSFORM_BATCH_GRAIN {4096u};
+
+// Unit quad corners in the order of generateRectangleVertices
+const mk::Space::Vec2 quadCorners[4] =
+{
+  {-0.5f,  0.5f},
+  { 0.5f,  0.5f},
+  {-0.5f, -0.5f},
+  { 0.5f, -0.5f},
+};
+
+mk::Space::Affine2D transformAt(const mk::Space::TransformArrays& input, const std::size_t index)
+{
+  return mk::Space::Affine2D::fromTransform(
+    {input.positionX[index], input.positionY[index]},
+    {input.scaleX[index], input.scaleY[index]},
+    input.rotation[index]
+  );
+}
+
+void quadCornersAt(const mk::Space::TransformArrays& input, const std::size_t index, mk::Space::Vec2* output)
+{
+  const mk::Space::Affine2D affine = transformAt(input, index);
+  for (int corner = 0; corner < 4; corner++)
+    output[corner] = mk::Space::transformPoint(affine, quadCorners[corner]);
+}
+
+template<typename Kernel>
+void runTransformBatch(const std::size_t count, const unsigned int threadCount, Kernel kernel)
+{
+  const std::size_t threads = std::max<std::size_t>(1u, std::min<std::size_t>(threadCount, count / TRANSFORM_BATCH_GRAIN));
+  if (threads == 1)
+  {
+    kernel(0, count);
+    return;
+  }
+
+  // Chunks are multiples of eight elements, so only the last one has a scalar tail
+  const std::size_t chunk = ((count + threads - 1) / threads + 7) / 8 * 8;
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (std::size_t begin = chunk; begin < count; begin += chunk)
+    workers.emplace_back(kernel, begin, std::min(begin + chunk, count));
+  kernel(0, std::min(chunk, count));
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+#if defined(MK_SIMD_SSE)
+// Sine and cosine of angles in degrees, reduced to [-pi/2, pi/2] and evaluated with Taylor polynomials
+void sinCos(const __m128 degrees, __m128& sine, __m128& cosine)
+{
+  const __m128 angle = _mm_mul_ps(degrees, _mm_set1_ps(mk::Space::PI / 180.f));
+  const __m128i halfTurns = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(0.318309886f)));
+  const __m128 turns = _mm_cvtepi32_ps(halfTurns);
+  __m128 reduced = _mm_sub_ps(angle, _mm_mul_ps(turns, _mm_set1_ps(3.140625f)));
+  reduced = _mm_sub_ps(reduced, _mm_mul_ps(turns, _mm_set1_ps(9.67653589793e-4f)));
+  const __m128 squared = _mm_mul_ps(reduced, reduced);
+
+  __m128 sinePolynomial = _mm_set1_ps(-2.50521084e-8f);
+  sinePolynomial = _mm_add_ps(_mm_mul_ps(sinePolynomial, squared), _mm_set1_ps(2.75573192e-6f));
+  sinePolynomial = _mm_add_ps(_mm_mul_ps(sinePolynomial, squared), _mm_set1_ps(-1.98412698e-4f));
+  sinePolynomial = _mm_add_ps(_mm_mul_ps(sinePolynomial, squared), _mm_set1_ps(8.33333333e-3f));
+  sinePolynomial = _mm_add_ps(_mm_mul_ps(sinePolynomial, squared), _mm_set1_ps(-1.66666667e-1f));
+  sinePolynomial = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinePolynomial, squared), reduced), reduced);
+
+  __m128 cosinePolynomial = _mm_set1_ps(2.08767570e-9f);
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(-2.75573192e-7f));
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(2.48015873e-5f));
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(-1.38888889e-3f));
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(4.16666667e-2f));
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(-0.5f));
+  cosinePolynomial = _mm_add_ps(_mm_mul_ps(cosinePolynomial, squared), _mm_set1_ps(1.f));
+
+  // An odd number of half turns flips the sign of both
+  const __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(halfTurns, 31));
+  sine = _mm_xor_ps(sinePolynomial, sign);
+  cosine = _mm_xor_ps(cosinePolynomial, sign);
+}
+
+// Computes the coefficients of four affine transforms starting at an index
+void affinesAt(const mk::Space::TransformArrays& input, const std::size_t index, __m128 coefficients[6])
+{
+  __m128 sine;
+  __m128 cosine;
+  sinCos(_mm_loadu_ps(input.rotation + index), sine, cosine);
+
+  const __m128 scaleX = _mm_loadu_ps(input.scaleX + index);
+  const __m128 scaleY = _mm_loadu_ps(input.scaleY + index);
+  coefficients[0] = _mm_mul_ps(cosine, scaleX);
+  coefficients[1] = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sine, scaleX));
+  coefficients[2] = _mm_mul_ps(sine, scaleY);
+  coefficients[3] = _mm_mul_ps(cosine, scaleY);
+  coefficients[4] = _mm_loadu_ps(input.positionX + index);
+  coefficients[5] = _mm_loadu_ps(input.positionY + index);
+}
+
+// Writes four affine transforms from the coefficients (a, b, c, d, tx, ty)
+void storeAffines(const __m128 coefficients[6], float* output)
+{
+  __m128 first = coefficients[0];
+  __m128 second = coefficients[2];
+  __m128 third = coefficients[4];
+  __m128 fourth = coefficients[1];
+  _MM_TRANSPOSE4_PS(first, second, third, fourth);
+  const __m128 low = _mm_unpacklo_ps(coefficients[3], coefficients[5]);
+  const __m128 high = _mm_unpackhi_ps(coefficients[3], coefficients[5]);
+
+  _mm_storeu_ps(output, first);
+  _mm_storel_pi(reinterpret_cast<__m64*>(output + 4), low);
+  _mm_storeu_ps(output + 6, second);
+  _mm_storeh_pi(reinterpret_cast<__m64*>(output + 10), low);
+  _mm_storeu_ps(output + 12, third);
+  _mm_storel_pi(reinterpret_cast<__m64*>(output + 16), high);
+  _mm_storeu_ps(output + 18, fourth);
+  _mm_storeh_pi(reinterpret_cast<__m64*>(output + 22), high);
+}
+
+// Writes the corners of four unit quads from the coefficients (a, b, c, d, tx, ty)
+void storeQuadCorners(const __m128 coefficients[6], float* output)
+{
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 a = _mm_mul_ps(coefficients[0], half);
+  const __m128 b = _mm_mul_ps(coefficients[1], half);
+  const __m128 c = _mm_mul_ps(coefficients[2], half);
+  const __m128 d = _mm_mul_ps(coefficients[3], half);
+
+  const __m128 upX = _mm_add_ps(coefficients[4], c);
+  const __m128 upY = _mm_add_ps(coefficients[5], d);
+  const __m128 downX = _mm_sub_ps(coefficients[4], c);
+  const __m128 downY = _mm_sub_ps(coefficients[5], d);
+
+  __m128 topLeftX = _mm_sub_ps(upX, a);
+  __m128 topLeftY = _mm_sub_ps(upY, b);
+  __m128 topRightX = _mm_add_ps(upX, a);
+  __m128 topRightY = _mm_add_ps(upY, b);
+  __m128 bottomLeftX = _mm_sub_ps(downX, a);
+  __m128 bottomLeftY = _mm_sub_ps(downY, b);
+  __m128 bottomRightX = _mm_add_ps(downX, a);
+  __m128 bottomRightY = _mm_add_ps(downY, b);
+  _MM_TRANSPOSE4_PS(topLeftX, topLeftY, topRightX, topRightY);
+  _MM_TRANSPOSE4_PS(bottomLeftX, bottomLeftY, bottomRightX, bottomRightY);
+
+  _mm_storeu_ps(output, topLeftX);
+  _mm_storeu_ps(output + 4, bottomLeftX);
+  _mm_storeu_ps(output + 8, topLeftY);
+  _mm_storeu_ps(output + 12, bottomLeftY);
+  _mm_storeu_ps(output + 16, topRightX);
+  _mm_storeu_ps(output + 20, bottomRightX);
+  _mm_storeu_ps(output + 24, topRightY);
+  _mm_storeu_ps(output + 28, bottomRightY);
+}
+#endif
+
+void mk::Space::Scalar::computeAffines(const mk::Space::TransformArrays& input, mk::Space::Affine2D* output)
+{
+  for (std::size_t i = 0; i < input.count; i++)
+    output[i] = transformAt(input, i);
+}
+
+void mk::Space::Scalar::computeQuadCorners(const mk::Space::TransformArrays& input, mk::Space::Vec2* output)
+{
+  for (std::size_t i = 0; i < input.count; i++)
+    quadCornersAt(input, i, output + i * 4);
+}
+
+void mk::Space::computeAffines(const mk::Space::TransformArrays& input, mk::Space::Affine2D* output, const unsigned int threadCount)
+{
+  runTransformBatch(input.count, threadCount, [&input, output](const std::size_t begin, const std::size_t end)
+  {
+    std::size_t i = begin;
+#if defined(MK_SIMD_SSE)
+    for (; i + 4 <= end; i += 4)
+    {
+      __m128 coefficients[6];
+      affinesAt(input, i, coefficients);
+      storeAffines(coefficients, &output[i][0][0]);
+    }
+#endif
+    for (; i < end; i++)
+      output[i] = transformAt(input, i);
+  });
+}
+
+void mk::Space::computeQuadCorners(const mk::Space::TransformArrays& input, mk::Space::Vec2* output, const unsigned int threadCount)
+{
+  runTransformBatch(input.count, threadCount, [&input, output](const std::size_t begin, const std::size_t end)
+  {
+    std::size_t i = begin;
+#if defined(MK_SIMD_SSE)
+    for (; i + 4 <= end; i += 4)
+    {
+      __m128 coefficients[6];
+      affinesAt(input, i, coefficients);
+      storeQuadCorners(coefficients, &output[i * 4].x);
+    }
+#endif
+    for (; i < end; i++)
+      quadCornersAt(input, i, output + i * 4);
+  });
+}
@@ -1,4 +1,14 @@
 #include <MK/Graphics.hpp>
+#include <bitset>
+#include <limits>
+
+#if !defined(MK_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+  #define MK_SIMD_SSE
+  #if defined(__AVX__)
+    #define MK_SIMD_AVX
+  #endif
+  #include <immintrin.h>
+#endif
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
@@ -31,15 +41,51 @@ std::array<GLfloat, 4 * 3> generateRectangleVertices(const float width, const fl
   };
 }
 
+std::vector<std::uint8_t> readFramebufferPixels(const GLsizei width, const GLsizei height)
+{
+  const std::size_t rowSize = static_cast<std::size_t>(width) * 4;
+  std::vector<std::uint8_t> pixels(rowSize * height);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+  // OpenGL returns the bottom row first.
+  for (GLsizei row = 0; row < height / 2; row++)
+    std::swap_ranges(
+      pixels.begin() + row * rowSize,
+      pixels.begin() + (row + 1) * rowSize,
+      pixels.begin() + (height - row - 1) * rowSize
+    );
+  return pixels;
+}
+
+struct GeometryEntry
+{
+  mk::Graphics::Geometry geometry;
+  unsigned int refCount {0};
+};
+
+GeometryEntry geometryEntries[static_cast<std::size_t>(mk::Graphics::Primitive::Count)];
+
+mk::Graphics::StateCache  fallbackStateCache;
+mk::Graphics::StateCache* currentStateCache {nullptr};
+
+mk::Graphics::FrameUniforms  fallbackFrameUniforms;
+mk::Graphics::FrameUniforms* currentFrameUniforms {nullptr};
+
+mk::Graphics::GPUProfiler  fallbackGPUProfiler;
+mk::Graphics::GPUProfiler* currentGPUProfiler {nullptr};
+
 mk::Graphics::Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
 {
+  MK_PROFILE_SCOPE("Shader::compile");
+
   // Shaders
   GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
   GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 
   // Shader Source Codes
-  std::string vertexShaderSource = mk::File::getContents("resources/Shaders/default.vert");
-  std::string fragmentShaderSource = mk::File::getContents("resources/Shaders/default.frag");
+  std::string vertexShaderSource = mk::File::getContents(vertexPath);
+  std::string fragmentShaderSource = mk::File::getContents(fragmentPath);
 
   const char* vertexShaderSourceC = vertexShaderSource.c_str();
   const char* fragmentShaderSourceC = fragmentShaderSource.c_str();
@@ -74,6 +120,7 @@ mk::Graphics::Shader::Shader(const std::string& vertexPath, const std::string& f
 
   // Shader Program
   ID = glCreateProgram();
+  mk::Graphics::StateCache::current().trackProgram();
   glAttachShader(ID, vertexShader);
   glAttachShader(ID, fragmentShader);
   glLinkProgram(ID);
@@ -85,6 +132,60 @@ mk::Graphics::Shader::Shader(const std::string& vertexPath, const std::string& f
     glGetProgramInfoLog(ID, mk::Constants::INFO_LOG_SIZE, NULL, infoLog);
     std::cerr << "Failed to link the shader program!\n";
     std::cerr << "Error: " << infoLog << '\n';
+    return;
+  }
+
+  // Per-Frame Uniform Block
+  GLuint frameBlockIndex = glGetUniformBlockIndex(ID, mk::Constants::FRAME_UNIFORM_BLOCK.c_str());
+  if (frameBlockIndex != GL_INVALID_INDEX)
+    glUniformBlockBinding(ID, frameBlockIndex, mk::Constants::FRAME_UNIFORM_BINDING);
+
+  _reflect();
+}
+
+void mk::Graphics::Shader::_reflect()
+{
+  GLint count {0};
+  GLint maxLength {0};
+  GLsizei length {0};
+
+  // Uniforms
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  std::vector<GLchar> name(std::max(maxLength, 1));
+  for (GLint i = 0; i < count; i++)
+  {
+    mk::Graphics::UniformInfo info;
+    glGetActiveUniform(ID, i, maxLength, &length, &info.size, &info.type, name.data());
+    info.name.assign(name.data(), length);
+    info.location = glGetUniformLocation(ID, info.name.c_str());
+
+    // Members of uniform blocks have no location
+    if (info.location < 0)
+      continue;
+
+    // Arrays are reported as "name[0]"
+    const std::size_t bracket = info.name.find('[');
+    if (bracket != std::string::npos)
+      info.name.erase(bracket);
+
+    uniformIndices[info.name] = static_cast<int>(uniforms.size());
+    uniforms.push_back(info);
+  }
+  uniformShadows.resize(uniforms.size());
+  uniformUploaded.assign(uniforms.size(), false);
+
+  // Attributes
+  glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTES, &count);
+  glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+  name.resize(std::max(maxLength, 1));
+  for (GLint i = 0; i < count; i++)
+  {
+    mk::Graphics::AttributeInfo info;
+    glGetActiveAttrib(ID, i, maxLength, &length, &info.size, &info.type, name.data());
+    info.name.assign(name.data(), length);
+    info.location = glGetAttribLocation(ID, info.name.c_str());
+    attributes.push_back(info);
   }
 }
 
@@ -93,11 +194,171 @@ void mk::Graphics::VAO::LinkAttrib(const mk::Graphics::VBO& VBO, GLuint layout,
   VBO.Bind();
   glVertexAttribPointer(layout, size, type, GL_FALSE, stride, offset);
   glEnableVertexAttribArray(layout);
-  VBO.Unbind();
+}
+
+void mk::Graphics::VAO::LinkAttrib(const mk::Graphics::RingBuffer& ring, GLuint layout, GLuint size, GLenum type, GLsizeiptr stride, const void* offset) const
+{
+  ring.Bind();
+  glVertexAttribPointer(layout, size, type, GL_FALSE, stride, offset);
+  glEnableVertexAttribArray(layout);
+}
+
+mk::Graphics::RingBuffer::RingBuffer(const GLsizeiptr regionSize, const unsigned int regionCount)
+: regionSize(regionSize), regionCount(regionCount), fences(regionCount, nullptr)
+{
+  _create();
+}
+
+void mk::Graphics::RingBuffer::Bind() const
+{
+  mk::Graphics::StateCache::current().bindBuffer(GL_ARRAY_BUFFER, this->ID);
+}
+
+void mk::Graphics::RingBuffer::Delete()
+{
+  if (ID == 0)
+    return;
+
+  if (persistent || mapped)
+  {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  for (GLsync& fence : fences)
+  {
+    if (fence != nullptr)
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+  glDeleteBuffers(1, &ID);
+  mk::Graphics::StateCache::current().forgetBuffer(ID);
+
+  ID = 0;
+  mapped = false;
+  persistentData = nullptr;
+}
+
+mk::Graphics::RingBuffer::Allocation mk::Graphics::RingBuffer::allocate(const GLsizeiptr size, const GLsizeiptr alignment)
+{
+  commit();
+
+  // The regions of previous frames are left to the GPU
+  const std::uint64_t currentFrame = mk::Graphics::StateCache::current().getFrame();
+  if (currentFrame != frame)
+  {
+    nextRegion();
+    frame = currentFrame;
+  }
+
+  GLsizeiptr offset = (head + alignment - 1) / alignment * alignment;
+  if (size > regionSize)
+  {
+    // The GPU keeps the old data store alive until pending draws are done
+    Delete();
+    regionSize = std::max(size, 2 * regionSize);
+    _create();
+    offset = 0;
+  }
+  else if (offset + size > regionSize)
+  {
+    nextRegion();
+    offset = 0;
+  }
+  head = offset + size;
+
+  mk::Graphics::StateCache::current().recordUpload(size);
+  mk::Graphics::RingBuffer::Allocation allocation;
+  allocation.offset = region * regionSize + offset;
+  allocation.size = size;
+  if (persistent)
+  {
+    allocation.data = persistentData + allocation.offset;
+  }
+  else
+  {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    allocation.data = glMapBufferRange(
+      GL_COPY_WRITE_BUFFER,
+      allocation.offset,
+      size,
+      GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+    );
+    mapped = true;
+  }
+  return allocation;
+}
+
+void mk::Graphics::RingBuffer::commit()
+{
+  if (!mapped)
+    return;
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+  glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  mapped = false;
+}
+
+void mk::Graphics::RingBuffer::nextRegion()
+{
+  if (head == 0)
+    return;
+
+  commit();
+  if (fences[region] != nullptr)
+    glDeleteSync(fences[region]);
+  fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  region = (region + 1) % regionCount;
+  head = 0;
+  _wait(region);
+}
+
+void mk::Graphics::RingBuffer::_create()
+{
+  const GLsizeiptr totalSize = regionSize * regionCount;
+
+  glGenBuffers(1, &ID);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+
+  persistent = GLEW_ARB_buffer_storage;
+  if (persistent)
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, NULL, flags);
+    persistentData = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+    persistent = persistentData != nullptr;
+  }
+  if (!persistent)
+  {
+    // Immutable storage cannot be respecified, so the fallback needs a fresh buffer
+    if (GLEW_ARB_buffer_storage)
+    {
+      glDeleteBuffers(1, &ID);
+      glGenBuffers(1, &ID);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+    }
+    glBufferData(GL_COPY_WRITE_BUFFER, totalSize, NULL, GL_STREAM_DRAW);
+  }
+  mk::Graphics::StateCache::current().trackBuffer();
+
+  region = 0;
+  head = 0;
+}
+
+void mk::Graphics::RingBuffer::_wait(const unsigned int index)
+{
+  if (fences[index] == nullptr)
+    return;
+
+  GLenum result {GL_TIMEOUT_EXPIRED};
+  while (result == GL_TIMEOUT_EXPIRED)
+    result = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+  glDeleteSync(fences[index]);
+  fences[index] = nullptr;
 }
 
 void mk::Window::_initialize()
 {
+  isHeadless = mk::Core::isHeadless();
   glfwInstance = glfwCreateWindow(
     this->width,
     this->height,
@@ -105,12 +366,27 @@ void mk::Window::_initialize()
     NULL,
     NULL
   );
+  if (glfwInstance == nullptr && isHeadless)
+  {
+    // Fall back to the software OSMesa context when EGL is unavailable.
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    glfwInstance = glfwCreateWindow(
+      this->width,
+      this->height,
+      this->title.c_str(),
+      NULL,
+      NULL
+    );
+  }
   if (glfwInstance == nullptr)
   {
     std::cerr << "Failed to create a GLFW window!\n";
     mk::Core::terminate();
   }
   glfwMakeContextCurrent(glfwInstance);
+  mk::Graphics::StateCache::setCurrent(&stateCache);
+  mk::Graphics::FrameUniforms::setCurrent(&frameUniforms);
+  mk::Graphics::GPUProfiler::setCurrent(&gpuProfiler);
   glfwSetWindowUserPointer(glfwInstance, this);
   glfwSetFramebufferSizeCallback(glfwInstance, framebufferSizeCallback);
   glClearColor(
@@ -121,11 +397,54 @@ void mk::Window::_initialize()
   );
 }
 
+mk::Window::~Window()
+{
+  if (&mk::Graphics::StateCache::current() == &stateCache)
+    mk::Graphics::StateCache::setCurrent(nullptr);
+  if (&mk::Graphics::FrameUniforms::current() == &frameUniforms)
+    mk::Graphics::FrameUniforms::setCurrent(nullptr);
+  if (&mk::Graphics::GPUProfiler::current() == &gpuProfiler)
+    mk::Graphics::GPUProfiler::setCurrent(nullptr);
+}
+
 void mk::Window::_updateDeltaTime()
 {
-  float currentTime = static_cast<float>(glfwGetTime());
-  deltaTime = currentTime - lastTime;
-  lastTime = currentTime;
+  clock.tick();
+}
+
+void mk::Window::_recordStats()
+{
+  frameStats = stateCache.getStats();
+  stateCache.resetStats();
+  if (statsHistory.empty())
+    return;
+  statsHistory[statsHistoryIndex] = frameStats;
+  statsHistoryIndex = (statsHistoryIndex + 1u) % statsHistory.size();
+  statsHistoryCount = std::min(statsHistoryCount + 1u, statsHistory.size());
+}
+
+std::vector<mk::Render::Stats> mk::Window::getStatsHistory() const
+{
+  std::vector<mk::Render::Stats> result;
+  result.reserve(statsHistoryCount);
+  const std::size_t first = (statsHistoryIndex + statsHistory.size() - statsHistoryCount) % std::max<std::size_t>(statsHistory.size(), 1u);
+  for (std::size_t i = 0; i < statsHistoryCount; i++)
+    result.push_back(statsHistory[(first + i) % statsHistory.size()]);
+  return result;
+}
+
+void mk::Window::setStatsHistorySize(const std::size_t size)
+{
+  statsHistory.assign(size, {});
+  statsHistoryIndex = 0u;
+  statsHistoryCount = 0u;
+}
+
+void mk::Window::resetStats()
+{
+  stateCache.resetStats();
+  frameStats.resetFrame();
+  setStatsHistorySize(statsHistory.size());
 }
 
 void mk::Window::maximize()
@@ -170,18 +489,59 @@ void mk::Window::unmaximize()
 
 void mk::Window::update()
 {
+  MK_PROFILE_SCOPE("Window::update");
   glfwPollEvents();
   _updateDeltaTime();
+  stateCache.beginFrame();
+  gpuProfiler.beginFrame();
+  frameUniforms.setTime(static_cast<float>(getTime()));
+}
+
+void mk::Window::_bindRenderTarget()
+{
+  if (!isHeadless)
+    return;
+
+  if (framebuffer != nullptr &&
+      (framebuffer->getWidth() != static_cast<GLsizei>(width) ||
+       framebuffer->getHeight() != static_cast<GLsizei>(height)))
+    framebuffer.reset();
+  if (framebuffer == nullptr)
+    framebuffer = std::make_unique<mk::Graphics::FBO>(width, height);
+  framebuffer->Bind();
 }
 
 void mk::Window::clear()
 {
+  MK_PROFILE_SCOPE("Window::clear");
+  gpuProfiler.nextPass("clear");
+  _bindRenderTarget();
   glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void mk::Window::display()
 {
-  glfwSwapBuffers(glfwInstance);
+  MK_PROFILE_SCOPE("Window::display");
+  gpuProfiler.nextPass("display");
+  for (auto& renderer : renderers)
+    renderer->flush();
+  gpuProfiler.endFrame();
+  _recordStats();
+  if (isHeadless)
+    glFlush();
+  else
+    glfwSwapBuffers(glfwInstance);
+}
+
+std::vector<std::uint8_t> mk::Window::readPixels()
+{
+  if (isHeadless)
+  {
+    _bindRenderTarget();
+    return framebuffer->ReadPixels();
+  }
+  mk::Graphics::StateCache::current().bindFramebuffer(0);
+  return readFramebufferPixels(width, height);
 }
 
 void mk::Window::addRenderer(const mk::Render::Renderer& renderer)
@@ -216,78 +576,1856 @@ void mk::Window::removeRenderer(const mk::Render::Renderer& renderer)
   }
 }
 
+mk::Render::Renderer::~Renderer()
+{
+  if (instanceVAO != nullptr)
+    mk::Graphics::GeometryRegistry::release(mk::Graphics::Primitive::Quad);
+}
+
 void mk::Render::Renderer::use()
 {
+  MK_PROFILE_SCOPE("Renderer::use");
+  mk::Graphics::GPUProfiler::current().nextPass(passName);
   shader.Use();
   camera.updateMatrix();
-  camera.applyMatrix(shader);
+  camera.applyMatrix();
 }
 
-void mk::Render::Renderer::render(const mk::Shapes::Shape& shape) const
+void mk::Render::Renderer::render(const mk::Shapes::Shape& shape)
 {
-  mk::Space::Vec2 offset = {shape.getBounds().width / 2.f, shape.getBounds().height / 2.f};
-  mk::Space::Mat4 model =
-    mk::Space::scale({1.f}, shape.getScale()) *
-    mk::Space::rotate({1.f} ,{0.f, 0.f, 1.f}, shape.getRotation()) *
-    mk::Space::translate({1.f}, shape.getPosition() + offset);
+  MK_PROFILE_SCOPE("Renderer::render");
+  const mk::Space::Affine2D model = shape.getTransform(interpolation);
+
+  // Deferred Path
+  if (queue != nullptr)
+  {
+    mk::Render::DrawCommand command;
+    command.renderer = this;
+    command.VAO = shape.getVAO()->getID();
+    command.indexCount = shape.getIndexCount();
+    command.model = model;
+    command.fillColor = shape.getFillColor().toRGBVec();
+
+    queue->submit(
+      mk::Render::RenderQueue::makeKey(shape.getLayer(), shader.getID(), command.VAO, static_cast<std::uint32_t>(queue->getSize())),
+      command
+    );
+    return;
+  }
+
+  // Instanced Path
+  if (instanced && shape.getPrimitive() == mk::Graphics::Primitive::Quad)
+  {
+    mk::Space::Vec3 fillColor = shape.getFillColor().toRGBVec();
+
+    mk::Render::InstanceData instance;
+    std::copy(mk::Space::valuePointer(model), mk::Space::valuePointer(model) + 6, instance.model);
+    instance.fillColor[0] = fillColor.x;
+    instance.fillColor[1] = fillColor.y;
+    instance.fillColor[2] = fillColor.z;
+    instances.push_back(instance);
+    return;
+  }
 
   shape.getVAO()->Bind();
-  shader.SetMat4("model", model);
-  shader.SetVec3("fillColor", shape.getFillColor().toRGBVec());
+  shader.SetInt(instancedUniform, GL_FALSE);
+  shader.SetAffine2D(modelUniform, model);
+  shader.SetVec3(fillColorUniform, shape.getFillColor().toRGBVec());
   glDrawElements(GL_TRIANGLES, shape.getIndexCount(), GL_UNSIGNED_INT, NULL);
-  shape.getVAO()->Unbind();
+  mk::Graphics::StateCache::current().recordDraw(shape.getIndexCount());
+}
+
+void mk::Render::Renderer::flush()
+{
+  MK_PROFILE_SCOPE("Renderer::flush");
+  if (queue != nullptr)
+    queue->flush();
+  if (instances.empty())
+    return;
+  if (instanceVAO == nullptr)
+    _initializeInstancing();
+
+  const GLsizeiptr size = instances.size() * sizeof(mk::Render::InstanceData);
+  mk::Graphics::RingBuffer::Allocation allocation = instanceRing->allocate(size);
+  std::memcpy(allocation.data, instances.data(), size);
+  instanceRing->commit();
+
+  // Another renderer may have applied its camera since use
+  shader.Use();
+  camera.updateMatrix();
+  camera.applyMatrix();
+  instanceVAO->Bind();
+
+  // Model Transform (one vec3 column of the mat2x3 per location)
+  for (GLuint column = 0; column < 2; column++)
+    instanceVAO->LinkAttrib(*instanceRing, 1 + column, 3, GL_FLOAT, sizeof(mk::Render::InstanceData), (void*)(allocation.offset + offsetof(mk::Render::InstanceData, model) + column * 3 * sizeof(GLfloat)));
+
+  // Fill Color
+  instanceVAO->LinkAttrib(*instanceRing, 3, 3, GL_FLOAT, sizeof(mk::Render::InstanceData), (void*)(allocation.offset + offsetof(mk::Render::InstanceData, fillColor)));
+
+  shader.SetInt(instancedUniform, GL_TRUE);
+  glDrawElementsInstanced(GL_TRIANGLES, rectangleIndices.size(), GL_UNSIGNED_INT, NULL, instances.size());
+  mk::Graphics::StateCache::current().recordDraw(rectangleIndices.size(), instances.size());
+  shader.SetInt(instancedUniform, GL_FALSE);
+
+  instances.clear();
+}
+
+void mk::Render::Renderer::draw(const mk::Render::DrawCommand& command)
+{
+  shader.Use();
+  camera.updateMatrix();
+  camera.applyMatrix();
+  mk::Graphics::StateCache::current().bindVertexArray(command.VAO);
+  shader.SetInt(instancedUniform, GL_FALSE);
+  shader.SetAffine2D(modelUniform, command.model);
+  shader.SetVec3(fillColorUniform, command.fillColor);
+  glDrawElements(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, NULL);
+  mk::Graphics::StateCache::current().recordDraw(command.indexCount);
+}
+
+void mk::Render::RenderQueue::flush()
+{
+  _sort();
+  for (const Entry& entry : entries)
+  {
+    const mk::Render::DrawCommand& command = commands[entry.index];
+    command.renderer->draw(command);
+  }
+
+  entries.clear();
+  commands.clear();
+}
+
+void mk::Render::RenderQueue::_sort()
+{
+  constexpr std::size_t DIGITS {8};
+  constexpr std::size_t BUCKETS {256};
+
+  if (entries.size() < 2)
+    return;
+
+  // Histograms of every byte in a single pass
+  std::uint32_t histograms[DIGITS][BUCKETS] {};
+  for (const Entry& entry : entries)
+    for (std::size_t digit = 0; digit < DIGITS; digit++)
+      histograms[digit][(entry.key >> (digit * 8)) & 0xFFu]++;
+
+  sortBuffer.resize(entries.size());
+  for (std::size_t digit = 0; digit < DIGITS; digit++)
+  {
+    std::uint32_t* histogram = histograms[digit];
+
+    // Every key has the same byte, so the pass would not change the order
+    if (histogram[(entries.front().key >> (digit * 8)) & 0xFFu] == entries.size())
+      continue;
+
+    std::uint32_t offset {0};
+    for (std::size_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+      const std::uint32_t count = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += count;
+    }
+    for (const Entry& entry : entries)
+      sortBuffer[histogram[(entry.key >> (digit * 8)) & 0xFFu]++] = entry;
+    entries.swap(sortBuffer);
+  }
+}
+
+void mk::Render::Renderer::_initializeInstancing()
+{
+  const mk::Graphics::Geometry& quad = mk::Graphics::GeometryRegistry::get(mk::Graphics::Primitive::Quad);
+  mk::Graphics::GeometryRegistry::retain(mk::Graphics::Primitive::Quad);
+
+  instanceVAO = std::make_unique<mk::Graphics::VAO>();
+  instanceRing = std::make_unique<mk::Graphics::RingBuffer>(mk::Constants::STREAM_REGION_SIZE);
+
+  instanceVAO->Bind();
+  quad.EBO->Bind();
+
+  // Unit Quad
+  instanceVAO->LinkAttrib(*quad.VBO, 0, 3, GL_FLOAT, 3 * sizeof(GLfloat), (void*)0);
+
+  // Per-instance attributes are linked at their ring offset on every flush
+  for (GLuint layout = 1; layout <= 3; layout++)
+    instanceVAO->SetAttribDivisor(layout, 1);
+}
+
+void mk::Render::BatchRenderer::setShader(mk::Graphics::Shader& shader)
+{
+  if (&shader == this->shader)
+    return;
+  flush();
+  this->shader = &shader;
+  this->shader->Use();
+  camera.updateMatrix();
+  camera.applyMatrix();
+}
+
+void mk::Render::BatchRenderer::use()
+{
+  MK_PROFILE_SCOPE("BatchRenderer::use");
+  mk::Graphics::GPUProfiler::current().nextPass(passName);
+  shader->Use();
+  camera.updateMatrix();
+  camera.applyMatrix();
+  drawCalls = 0;
+}
+
+void mk::Render::BatchRenderer::submit(const mk::Shapes::Shape& shape)
+{
+  if (shape.getPrimitive() != mk::Graphics::Primitive::Quad)
+    return;
+
+  const mk::Space::Affine2D model = shape.getTransform(interpolation);
+  const mk::Space::Vec3 color = shape.getFillColor().toRGBVec();
+
+  // Same corner order as generateRectangleVertices, on the unit quad the transform is built for
+  const mk::Space::Vec2 corners[4] =
+  {
+    {-0.5f,  0.5f},
+    { 0.5f,  0.5f},
+    {-0.5f, -0.5f},
+    { 0.5f, -0.5f},
+  };
+  for (const auto& corner : corners)
+  {
+    const mk::Space::Vec2 position = mk::Space::transformPoint(model, corner);
+    vertices.push_back({
+      {position.x, position.y, 0.f},
+      {color.x, color.y, color.z},
+    });
+  }
+}
+
+void mk::Render::BatchRenderer::submit(const mk::Space::Vec2* corners, const mk::Space::Vec3* colors, const std::size_t count)
+{
+  vertices.reserve(vertices.size() + count * 4);
+  for (std::size_t quad = 0; quad < count; quad++)
+  {
+    const mk::Space::Vec3& color = colors[quad];
+    for (std::size_t corner = quad * 4; corner < quad * 4 + 4; corner++)
+      vertices.push_back({
+        {corners[corner].x, corners[corner].y, 0.f},
+        {color.x, color.y, color.z},
+      });
+  }
+}
+
+void mk::Render::BatchRenderer::flush()
+{
+  MK_PROFILE_SCOPE("BatchRenderer::flush");
+  if (vertices.empty())
+    return;
+  if (VAO == nullptr)
+    _initialize();
+
+  const GLsizeiptr size = vertices.size() * sizeof(mk::Render::BatchVertex);
+  mk::Graphics::RingBuffer::Allocation allocation = ring->allocate(size);
+  std::memcpy(allocation.data, vertices.data(), size);
+  ring->commit();
+
+  // Another renderer may have applied its camera since use
+  shader->Use();
+  camera.updateMatrix();
+  camera.applyMatrix();
+  VAO->Bind();
+  _reserveQuads(vertices.size() / 4);
+  VAO->LinkAttrib(*ring, 0, 3, GL_FLOAT, sizeof(mk::Render::BatchVertex), (void*)(allocation.offset + offsetof(mk::Render::BatchVertex, position)));
+  VAO->LinkAttrib(*ring, 1, 3, GL_FLOAT, sizeof(mk::Render::BatchVertex), (void*)(allocation.offset + offsetof(mk::Render::BatchVertex, color)));
+  glDrawElements(GL_TRIANGLES, (vertices.size() / 4) * rectangleIndices.size(), GL_UNSIGNED_INT, NULL);
+  mk::Graphics::StateCache::current().recordDraw((vertices.size() / 4) * rectangleIndices.size());
+
+  vertices.clear();
+  drawCalls++;
 }
 
-mk::Shapes::Rectangle::Rectangle(const mk::Space::Vec2& position, const float width, const float height)
-: mk::Shapes::Shape(position, 6), width(width), height(height)
+void mk::Render::BatchRenderer::_initialize()
 {
-  VAO = new mk::Graphics::VAO();
-  VBO = new mk::Graphics::VBO(generateRectangleVertices(width, height));
-  EBO = new mk::Graphics::EBO(rectangleIndices);
+  VAO = std::make_unique<mk::Graphics::VAO>();
+  EBO = std::make_unique<mk::Graphics::EBO>(GL_STATIC_DRAW);
+  ring = std::make_unique<mk::Graphics::RingBuffer>(mk::Constants::STREAM_REGION_SIZE);
 
   VAO->Bind();
-  VBO->Bind();
   EBO->Bind();
+}
 
-  VAO->LinkAttrib(*VBO, 0, 3, GL_FLOAT, 3 * sizeof(GLfloat), (void*)0);
+void mk::Render::BatchRenderer::_reserveQuads(const std::size_t quadCount)
+{
+  if (quadCount <= quadCapacity)
+    return;
 
-  VAO->Unbind();
-  VBO->Unbind();
-  EBO->Unbind();
+  quadCapacity = std::max(quadCount, 2 * quadCapacity);
+  std::vector<GLuint> indices;
+  indices.reserve(quadCapacity * rectangleIndices.size());
+  for (std::size_t quad = 0; quad < quadCapacity; quad++)
+    for (const GLuint index : rectangleIndices)
+      indices.push_back(static_cast<GLuint>(quad * 4 + index));
+  EBO->SetData(indices.data(), indices.size() * sizeof(GLuint));
 }
 
-void mk::Camera2D::updateMatrix()
+void mk::Shapes::Shape::updateTransform() const
 {
-  constexpr float targetAspect =
-    static_cast<float>(mk::Constants::RENDER_WIDTH) / static_cast<float>(mk::Constants::RENDER_HEIGHT);
+  transform = mk::Space::Affine2D::fromTransform(position + size / 2.f, {size.x * scale.x, size.y * scale.y}, rotation);
+  isTransformDirty = false;
+}
 
-  float aspectWidth = bufferDimensions.x;
-  float aspectHeight = bufferDimensions.x / targetAspect;
+mk::Space::Affine2D mk::Shapes::Shape::getTransform(const float alpha) const
+{
+  if (!isInterpolated)
+    return getTransform();
 
-  if (aspectHeight > bufferDimensions.y)
+  const bool isMoving =
+    previousPosition.x != position.x || previousPosition.y != position.y ||
+    previousScale.x != scale.x || previousScale.y != scale.y ||
+    previousRotation != rotation;
+  if (alpha >= 1.f || !isMoving)
+    return getTransform();
+
+  // Rotations are interpolated the short way around, which the wrapped angles can hide
+  const mk::Space::Vec2 interpolatedPosition = previousPosition + (position - previousPosition) * alpha;
+  const mk::Space::Vec2 interpolatedScale = previousScale + (scale - previousScale) * alpha;
+  const float interpolatedRotation = previousRotation + std::remainderf(rotation - previousRotation, 360.f) * alpha;
+  return mk::Space::Affine2D::fromTransform(interpolatedPosition + size / 2.f, {size.x * interpolatedScale.x, size.y * interpolatedScale.y}, interpolatedRotation);
+}
+
+void mk::Shapes::Shape::updateAxes() const
+{
+  // The same directions as the columns of the model transform, without the scale
+  const float cosTheta = std::cos(mk::Space::radians(rotation));
+  const float sinTheta = std::sin(mk::Space::radians(rotation));
+  axes[0] = {cosTheta, -sinTheta};
+  axes[1] = {sinTheta, cosTheta};
+  isAxesDirty = false;
+}
+
+mk::Shapes::BoundRect mk::Shapes::Rectangle::getBounds() const
+{
+  if (rotation != 0.f)
+    return getOrientedBox().getBounds();
+
+  const float width = std::abs(size.x * scale.x);
+  const float height = std::abs(size.y * scale.y);
+  return BoundRect(position.x + (size.x - width) / 2.f, position.y + (size.y - height) / 2.f, width, height);
+}
+
+mk::Shapes::BoundRect mk::Shapes::OrientedBox::getBounds() const
+{
+  const float extentX = std::abs(axes[0].x) * halfExtents.x + std::abs(axes[1].x) * halfExtents.y;
+  const float extentY = std::abs(axes[0].y) * halfExtents.x + std::abs(axes[1].y) * halfExtents.y;
+  return BoundRect(center.x - extentX, center.y - extentY, extentX * 2.f, extentY * 2.f);
+}
+
+mk::Shapes::ConvexPolygon::ConvexPolygon(const mk::Space::Vec2* vertices, const int count)
+: count(std::min(count, mk::Constants::POLYGON_MAX_VERTICES))
+{
+  if (count > mk::Constants::POLYGON_MAX_VERTICES)
+    std::cerr << "ERROR::CONVEX_POLYGON::TOO_MANY_VERTICES\n" << count << " vertices given, only the first " << mk::Constants::POLYGON_MAX_VERTICES << " are used" << std::endl;
+
+  std::copy(vertices, vertices + this->count, this->vertices.begin());
+  _computeNormals();
+}
+
+mk::Shapes::ConvexPolygon::ConvexPolygon(const mk::Shapes::OrientedBox& box)
+: count(4)
+{
+  const mk::Space::Vec2 width = box.axes[0] * box.halfExtents.x;
+  const mk::Space::Vec2 height = box.axes[1] * box.halfExtents.y;
+  vertices[0] = box.center - width - height;
+  vertices[1] = box.center + width - height;
+  vertices[2] = box.center + width + height;
+  vertices[3] = box.center - width + height;
+  normals[0] = -box.axes[1];
+  normals[1] = box.axes[0];
+  normals[2] = box.axes[1];
+  normals[3] = -box.axes[0];
+}
+
+mk::Shapes::BoundRect mk::Shapes::ConvexPolygon::getBounds() const
+{
+  if (count == 0)
+    return BoundRect(0.f, 0.f, 0.f, 0.f);
+
+  mk::Space::Vec2 lower = vertices[0];
+  mk::Space::Vec2 upper = vertices[0];
+  for (int i = 1; i < count; i++)
   {
-    aspectHeight = bufferDimensions.y;
-    aspectWidth = aspectHeight * targetAspect;
+    lower = {std::min(lower.x, vertices[i].x), std::min(lower.y, vertices[i].y)};
+    upper = {std::max(upper.x, vertices[i].x), std::max(upper.y, vertices[i].y)};
   }
+  return BoundRect(lower.x, lower.y, upper.x - lower.x, upper.y - lower.y);
+}
 
-  float paddingTop = bufferDimensions.y / 2.f - aspectHeight / 2.f;
-  float paddingLeft = bufferDimensions.x / 2.f - aspectWidth / 2.f;
+mk::Shapes::ConvexPolygon mk::Shapes::ConvexPolygon::transformed(const mk::Space::Affine2D& transform) const
+{
+  mk::Space::Vec2 points[mk::Constants::POLYGON_MAX_VERTICES];
+  for (int i = 0; i < count; i++)
+    points[i] = mk::Space::transformPoint(transform, vertices[i]);
+  return ConvexPolygon(points, count);
+}
 
-  glViewport
-  (
-    paddingLeft,
-    paddingTop,
-    aspectWidth,
-    aspectHeight
-  );
-  mk::Space::Mat4 projection = mk::Space::ortho(
-    0.f,
-    mk::Constants::RENDER_WIDTH,
-    0.f,
-    mk::Constants::RENDER_HEIGHT,
-    -1.f,
-    1.f
-  );
+void mk::Shapes::ConvexPolygon::_computeNormals()
+{
+  // The sign of the area gives the winding, which decides on which side of each edge the outside is
+  float area {0.f};
+  for (int i = 0; i < count; i++)
+  {
+    const mk::Space::Vec2& next = vertices[(i + 1) % count];
+    area += vertices[i].x * next.y - next.x * vertices[i].y;
+  }
+  const float side = area < 0.f ? -1.f : 1.f;
 
-  matrix = projection;
+  for (int i = 0; i < count; i++)
+  {
+    const mk::Space::Vec2 edge = vertices[(i + 1) % count] - vertices[i];
+    normals[i] = mk::Space::normalize(mk::Space::Vec2(edge.y, -edge.x) * side);
+  }
+}
+
+mk::Graphics::FBO::FBO(const GLsizei width, const GLsizei height)
+: width(width), height(height)
+{
+  glGenRenderbuffers(1, &this->colorID);
+  glBindRenderbuffer(GL_RENDERBUFFER, this->colorID);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenFramebuffers(1, &this->ID);
+  mk::Graphics::StateCache::current().trackFramebuffer();
+  Bind();
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colorID);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::cerr << "Framebuffer is incomplete!\n";
+}
+
+std::vector<std::uint8_t> mk::Graphics::FBO::ReadPixels() const
+{
+  Bind();
+  return readFramebufferPixels(width, height);
+}
+
+mk::Graphics::StateCache& mk::Graphics::StateCache::current()
+{
+  return currentStateCache != nullptr ? *currentStateCache : fallbackStateCache;
+}
+
+void mk::Graphics::StateCache::setCurrent(mk::Graphics::StateCache* cache)
+{
+  currentStateCache = cache;
+}
+
+mk::Graphics::FrameUniforms& mk::Graphics::FrameUniforms::current()
+{
+  return currentFrameUniforms != nullptr ? *currentFrameUniforms : fallbackFrameUniforms;
+}
+
+void mk::Graphics::FrameUniforms::setCurrent(mk::Graphics::FrameUniforms* frameUniforms)
+{
+  currentFrameUniforms = frameUniforms;
+}
+
+void mk::Graphics::FrameUniforms::setCamera(const mk::Space::Mat4& cameraMatrix, const GLfloat viewport[4])
+{
+  const bool matrixChanged = std::memcmp(data.cameraMatrix, mk::Space::valuePointer(cameraMatrix), sizeof(data.cameraMatrix)) != 0;
+  const bool viewportChanged = std::memcmp(data.viewport, viewport, sizeof(data.viewport)) != 0;
+  if (UBO != nullptr && !matrixChanged && !viewportChanged)
+    return;
+
+  std::memcpy(data.cameraMatrix, mk::Space::valuePointer(cameraMatrix), sizeof(data.cameraMatrix));
+  std::memcpy(data.viewport, viewport, sizeof(data.viewport));
+  _upload(offsetof(mk::Graphics::FrameData, cameraMatrix), sizeof(data.cameraMatrix) + sizeof(data.viewport));
+}
+
+void mk::Graphics::FrameUniforms::setTime(const GLfloat time)
+{
+  if (UBO != nullptr && data.time == time)
+    return;
+
+  data.time = time;
+  _upload(offsetof(mk::Graphics::FrameData, time), sizeof(data.time));
+}
+
+void mk::Graphics::FrameUniforms::_upload(GLintptr offset, GLsizeiptr size)
+{
+  if (UBO == nullptr)
+  {
+    UBO = std::make_unique<mk::Graphics::UBO>(sizeof(mk::Graphics::FrameData));
+    UBO->BindBase(mk::Constants::FRAME_UNIFORM_BINDING);
+    offset = 0;
+    size = sizeof(mk::Graphics::FrameData);
+  }
+  UBO->SetSubData(offset, size, reinterpret_cast<const char*>(&data) + offset);
+  uploads++;
+}
+
+mk::Graphics::GPUProfiler::~GPUProfiler()
+{
+  for (Frame& frame : frames)
+    if (!frame.queries.empty())
+      glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+}
+
+mk::Graphics::GPUProfiler& mk::Graphics::GPUProfiler::current()
+{
+  return currentGPUProfiler != nullptr ? *currentGPUProfiler : fallbackGPUProfiler;
+}
+
+void mk::Graphics::GPUProfiler::setCurrent(mk::Graphics::GPUProfiler* profiler)
+{
+  currentGPUProfiler = profiler;
+}
+
+void mk::Graphics::GPUProfiler::setEnabled(const bool isEnabled)
+{
+  if (isEnabled && !GLEW_VERSION_3_3 && !GLEW_ARB_timer_query)
+  {
+    std::cerr << "ERROR::GPU_PROFILER::TIMER_QUERY_UNSUPPORTED\nTimestamp queries need OpenGL 3.3 or ARB_timer_query" << std::endl;
+    return;
+  }
+  this->isEnabled = isEnabled;
+  if (isEnabled)
+    return;
+
+  // Results in flight are abandoned, but the query objects are kept for later use
+  isFrameOpen = false;
+  openPasses.clear();
+  for (Frame& frame : frames)
+    frame.isPending = false;
+}
+
+void mk::Graphics::GPUProfiler::beginFrame()
+{
+  if (!isEnabled)
+    return;
+  if (isFrameOpen)
+    endFrame();
+
+  // The frame reused is the oldest in flight, issued GPU_PROFILER_FRAME_COUNT frames ago
+  frameIndex = (frameIndex + 1u) % mk::Constants::GPU_PROFILER_FRAME_COUNT;
+  Frame& frame = frames[frameIndex];
+  if (frame.isPending)
+    _collect(frame);
+  frame.queryCount = 0;
+  frame.passes.clear();
+  frame.isPending = false;
+  isFrameOpen = true;
+  _timestamp();
+}
+
+void mk::Graphics::GPUProfiler::endFrame()
+{
+  if (!isFrameOpen)
+    return;
+  while (!openPasses.empty())
+    endPass();
+  _timestamp();
+  frames[frameIndex].isPending = true;
+  isFrameOpen = false;
+}
+
+void mk::Graphics::GPUProfiler::beginPass(const char* name)
+{
+  if (!isFrameOpen)
+    return;
+  Frame& frame = frames[frameIndex];
+  frame.passes.push_back({name, _timestamp(), -1, static_cast<int>(openPasses.size())});
+  openPasses.push_back(static_cast<int>(frame.passes.size()) - 1);
+}
+
+void mk::Graphics::GPUProfiler::endPass()
+{
+  if (!isFrameOpen || openPasses.empty())
+    return;
+  frames[frameIndex].passes[openPasses.back()].endQuery = _timestamp();
+  openPasses.pop_back();
+}
+
+void mk::Graphics::GPUProfiler::nextPass(const char* name)
+{
+  if (!isFrameOpen)
+    return;
+  while (openPasses.size() > 1u)
+    endPass();
+
+  // The end of the previous top-level pass and the start of the next one share a timestamp
+  Frame& frame = frames[frameIndex];
+  const int query = _timestamp();
+  if (!openPasses.empty())
+  {
+    frame.passes[openPasses.back()].endQuery = query;
+    openPasses.pop_back();
+  }
+  frame.passes.push_back({name, query, -1, 0});
+  openPasses.push_back(static_cast<int>(frame.passes.size()) - 1);
+}
+
+int mk::Graphics::GPUProfiler::_timestamp()
+{
+  Frame& frame = frames[frameIndex];
+  if (frame.queryCount == static_cast<int>(frame.queries.size()))
+  {
+    GLuint query;
+    glGenQueries(1, &query);
+    frame.queries.push_back(query);
+  }
+  glQueryCounter(frame.queries[frame.queryCount], GL_TIMESTAMP);
+  return frame.queryCount++;
+}
+
+void mk::Graphics::GPUProfiler::_collect(Frame& frame)
+{
+  for (int i = frame.queryCount - 1; i >= 0; i--)
+  {
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable == GL_FALSE)
+    {
+      droppedFrames++;
+      return;
+    }
+  }
+
+  timestamps.resize(frame.queryCount);
+  for (int i = 0; i < frame.queryCount; i++)
+    glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+  const auto elapsed = [this](const int from, const int to)
+  { return static_cast<std::int64_t>(timestamps[to] - timestamps[from]); };
+  passes.clear();
+  for (const PendingPass& pass : frame.passes)
+    if (pass.endQuery >= 0)
+      passes.push_back({pass.name, elapsed(0, pass.beginQuery), elapsed(pass.beginQuery, pass.endQuery), pass.depth});
+  frameTime = elapsed(0, frame.queryCount - 1);
+}
+
+void mk::Graphics::GeometryRegistry::retain(const mk::Graphics::Primitive primitive)
+{
+  geometryEntries[static_cast<std::size_t>(primitive)].refCount++;
+}
+
+void mk::Graphics::GeometryRegistry::release(const mk::Graphics::Primitive primitive)
+{
+  GeometryEntry& entry = geometryEntries[static_cast<std::size_t>(primitive)];
+  if (entry.refCount == 0 || --entry.refCount > 0)
+    return;
+
+  delete entry.geometry.VAO;
+  delete entry.geometry.VBO;
+  delete entry.geometry.EBO;
+  entry.geometry.VAO = nullptr;
+  entry.geometry.VBO = nullptr;
+  entry.geometry.EBO = nullptr;
+}
+
+const mk::Graphics::Geometry& mk::Graphics::GeometryRegistry::get(const mk::Graphics::Primitive primitive)
+{
+  GeometryEntry& entry = geometryEntries[static_cast<std::size_t>(primitive)];
+  if (entry.geometry.VAO != nullptr)
+    return entry.geometry;
+
+  switch (primitive)
+  {
+    case mk::Graphics::Primitive::Quad:
+      entry.geometry.VAO = new mk::Graphics::VAO();
+      entry.geometry.VBO = new mk::Graphics::VBO(generateRectangleVertices(1.f, 1.f));
+      entry.geometry.EBO = new mk::Graphics::EBO(rectangleIndices);
+      break;
+    default:
+      std::cerr << "ERROR::GEOMETRY_REGISTRY::UNKNOWN_PRIMITIVE\n" << static_cast<int>(primitive) << " has no geometry" << std::endl;
+      return entry.geometry;
+  }
+  entry.geometry.indexCount = getIndexCount(primitive);
+
+  entry.geometry.VAO->Bind();
+  entry.geometry.EBO->Bind();
+
+  entry.geometry.VAO->LinkAttrib(*entry.geometry.VBO, 0, 3, GL_FLOAT, 3 * sizeof(GLfloat), (void*)0);
+
+  return entry.geometry;
+}
+
+GLsizei mk::Graphics::GeometryRegistry::getIndexCount(const mk::Graphics::Primitive primitive)
+{
+  switch (primitive)
+  {
+    case mk::Graphics::Primitive::Quad:
+      return rectangleIndices.size();
+    default:
+      return 0;
+  }
+}
+
+unsigned int mk::Graphics::GeometryRegistry::getRefCount(const mk::Graphics::Primitive primitive)
+{
+  return geometryEntries[static_cast<std::size_t>(primitive)].refCount;
+}
+
+void mk::Camera2D::updateMatrix()
+{
+  constexpr float targetAspect =
+    static_cast<float>(mk::Constants::RENDER_WIDTH) / static_cast<float>(mk::Constants::RENDER_HEIGHT);
+
+  float aspectWidth = bufferDimensions.x;
+  float aspectHeight = bufferDimensions.x / targetAspect;
+
+  if (aspectHeight > bufferDimensions.y)
+  {
+    aspectHeight = bufferDimensions.y;
+    aspectWidth = aspectHeight * targetAspect;
+  }
+
+  float paddingTop = bufferDimensions.y / 2.f - aspectHeight / 2.f;
+  float paddingLeft = bufferDimensions.x / 2.f - aspectWidth / 2.f;
+
+  viewport[0] = paddingLeft;
+  viewport[1] = paddingTop;
+  viewport[2] = aspectWidth;
+  viewport[3] = aspectHeight;
+
+  mk::Graphics::StateCache::current().setViewport
+  (
+    paddingLeft,
+    paddingTop,
+    aspectWidth,
+    aspectHeight
+  );
+  mk::Space::Mat4 projection = mk::Space::ortho(
+    0.f,
+    mk::Constants::RENDER_WIDTH,
+    0.f,
+    mk::Constants::RENDER_HEIGHT,
+    -1.f,
+    1.f
+  );
+
+  matrix = projection;
+}
+
+bool boxesOverlap(const mk::Space::Vec2& lowerOne, const mk::Space::Vec2& upperOne, const mk::Space::Vec2& lowerTwo, const mk::Space::Vec2& upperTwo)
+{
+  return
+    lowerOne.x < upperTwo.x &&
+    upperOne.x > lowerTwo.x &&
+    lowerOne.y < upperTwo.y &&
+    upperOne.y > lowerTwo.y;
+}
+
+float boxPerimeter(const mk::Space::Vec2& lower, const mk::Space::Vec2& upper)
+{
+  return 2.f * ((upper.x - lower.x) + (upper.y - lower.y));
+}
+
+// Slab test of the segment origin + fraction * delta against a box, for fractions in [0, maxFraction]
+bool segmentFraction(const mk::Space::Vec2& lower, const mk::Space::Vec2& upper, const mk::Space::Vec2& origin, const mk::Space::Vec2& delta, const float maxFraction, float& fraction)
+{
+  float entry {0.f};
+  float exit {maxFraction};
+  const float origins[2] {origin.x, origin.y};
+  const float deltas[2] {delta.x, delta.y};
+  const float lowers[2] {lower.x, lower.y};
+  const float uppers[2] {upper.x, upper.y};
+  for (int axis = 0; axis < 2; axis++)
+  {
+    if (deltas[axis] == 0.f)
+    {
+      if (origins[axis] < lowers[axis] || origins[axis] > uppers[axis])
+        return false;
+      continue;
+    }
+    const float inverseDelta = 1.f / deltas[axis];
+    float near = (lowers[axis] - origins[axis]) * inverseDelta;
+    float far = (uppers[axis] - origins[axis]) * inverseDelta;
+    if (near > far)
+      std::swap(near, far);
+    entry = std::max(entry, near);
+    exit = std::min(exit, far);
+    if (entry > exit)
+      return false;
+  }
+  fraction = entry;
+  return true;
+}
+
+// Sweeps the box [lowerOne, upperOne] along motion against [lowerTwo, upperTwo], for times in [0, maxTime)
+bool sweepBoxes(const mk::Space::Vec2& lowerOne, const mk::Space::Vec2& upperOne, const mk::Space::Vec2& motion, const mk::Space::Vec2& lowerTwo, const mk::Space::Vec2& upperTwo, const float maxTime, mk::Shapes::Collision::SweepHit& hit)
+{
+  float entry {std::numeric_limits<float>::lowest()};
+  float exit {maxTime};
+  int entryAxis {-1};
+  const float motions[2] {motion.x, motion.y};
+  const float lowersOne[2] {lowerOne.x, lowerOne.y};
+  const float uppersOne[2] {upperOne.x, upperOne.y};
+  const float lowersTwo[2] {lowerTwo.x, lowerTwo.y};
+  const float uppersTwo[2] {upperTwo.x, upperTwo.y};
+  for (int axis = 0; axis < 2; axis++)
+  {
+    if (motions[axis] == 0.f)
+    {
+      if (lowersOne[axis] >= uppersTwo[axis] || uppersOne[axis] <= lowersTwo[axis])
+        return false;
+      continue;
+    }
+    const float inverseMotion = 1.f / motions[axis];
+    const bool isForward = motions[axis] > 0.f;
+    const float near = (isForward ? lowersTwo[axis] - uppersOne[axis] : uppersTwo[axis] - lowersOne[axis]) * inverseMotion;
+    const float far = (isForward ? uppersTwo[axis] - lowersOne[axis] : lowersTwo[axis] - uppersOne[axis]) * inverseMotion;
+    if (near > entry)
+    {
+      entry = near;
+      entryAxis = axis;
+    }
+    exit = std::min(exit, far);
+  }
+  if (entry >= exit || exit <= 0.f)
+    return false;
+
+  // Boxes overlapping before the motion hit immediately, without a face to report
+  if (entry < 0.f)
+  {
+    hit.time = 0.f;
+    hit.normal = {0.f};
+    return true;
+  }
+  hit.time = entry;
+  hit.normal = {0.f};
+  (entryAxis == 0 ? hit.normal.x : hit.normal.y) = motions[entryAxis] > 0.f ? -1.f : 1.f;
+  return true;
+}
+
+bool mk::Shapes::Collision::SweptAABB(const mk::Shapes::BoundRect& rect, const mk::Space::Vec2& motion, const mk::Shapes::BoundRect& target, mk::Shapes::Collision::SweepHit& hit)
+{
+  return sweepBoxes(
+    {rect.x, rect.y},
+    {rect.x + rect.width, rect.y + rect.height},
+    motion,
+    {target.x, target.y},
+    {target.x + target.width, target.y + target.height},
+    1.f,
+    hit
+  );
+}
+
+int mk::Shapes::Collision::AABBTree::insert(const mk::Shapes::BoundRect& bounds, void* userData)
+{
+  const int proxy = _allocateNode();
+  Node& node = nodes[proxy];
+  node.tightLower = {bounds.x, bounds.y};
+  node.tightUpper = {bounds.x + bounds.width, bounds.y + bounds.height};
+  node.lower = node.tightLower - mk::Space::Vec2(margin);
+  node.upper = node.tightUpper + mk::Space::Vec2(margin);
+  node.userData = userData;
+  node.height = 0;
+
+  _insertLeaf(proxy);
+  proxyCount++;
+  return proxy;
+}
+
+void mk::Shapes::Collision::AABBTree::remove(const int proxy)
+{
+  _removeLeaf(proxy);
+  _freeNode(proxy);
+  proxyCount--;
+}
+
+bool mk::Shapes::Collision::AABBTree::move(const int proxy, const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& displacement)
+{
+  Node& node = nodes[proxy];
+  node.tightLower = {bounds.x, bounds.y};
+  node.tightUpper = {bounds.x + bounds.width, bounds.y + bounds.height};
+  if (node.lower.x <= node.tightLower.x && node.lower.y <= node.tightLower.y &&
+      node.upper.x >= node.tightUpper.x && node.upper.y >= node.tightUpper.y)
+    return false;
+
+  _removeLeaf(proxy);
+
+  // Fatten the bounds, then stretch them along the predicted motion
+  Node& leaf = nodes[proxy];
+  leaf.lower = leaf.tightLower - mk::Space::Vec2(margin);
+  leaf.upper = leaf.tightUpper + mk::Space::Vec2(margin);
+  const mk::Space::Vec2 prediction = displacement * 2.f;
+  if (prediction.x < 0.f)
+    leaf.lower.x += prediction.x;
+  else
+    leaf.upper.x += prediction.x;
+  if (prediction.y < 0.f)
+    leaf.lower.y += prediction.y;
+  else
+    leaf.upper.y += prediction.y;
+
+  _insertLeaf(proxy);
+  return true;
+}
+
+void mk::Shapes::Collision::AABBTree::clear()
+{
+  nodes.clear();
+  root = NULL_PROXY;
+  freeList = NULL_PROXY;
+  proxyCount = 0;
+}
+
+void mk::Shapes::Collision::AABBTree::query(const mk::Shapes::BoundRect& region, std::vector<int>& proxies) const
+{
+  proxies.clear();
+  if (root == NULL_PROXY)
+    return;
+
+  const mk::Space::Vec2 lower {region.x, region.y};
+  const mk::Space::Vec2 upper {region.x + region.width, region.y + region.height};
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty())
+  {
+    const Node& node = nodes[stack.back()];
+    const int index = stack.back();
+    stack.pop_back();
+    if (!boxesOverlap(node.lower, node.upper, lower, upper))
+      continue;
+
+    if (node.isLeaf())
+    {
+      if (boxesOverlap(node.tightLower, node.tightUpper, lower, upper))
+        proxies.push_back(index);
+    }
+    else
+    {
+      stack.push_back(node.childOne);
+      stack.push_back(node.childTwo);
+    }
+  }
+}
+
+void mk::Shapes::Collision::AABBTree::queryPairs(std::vector<mk::Shapes::Collision::AABBTree::Pair>& pairs) const
+{
+  pairs.clear();
+
+  // Every overlapping pair of leaves is found once, below their lowest common ancestor, by descending
+  // the two subtrees of each internal node against each other
+  std::vector<std::pair<int, int>> stack;
+  stack.reserve(64);
+  for (const Node& node : nodes)
+  {
+    if (node.height <= 0)
+      continue;
+
+    stack.push_back({node.childOne, node.childTwo});
+    while (!stack.empty())
+    {
+      const int indexOne = stack.back().first;
+      const int indexTwo = stack.back().second;
+      const Node& nodeOne = nodes[indexOne];
+      const Node& nodeTwo = nodes[indexTwo];
+      stack.pop_back();
+      if (!boxesOverlap(nodeOne.lower, nodeOne.upper, nodeTwo.lower, nodeTwo.upper))
+        continue;
+
+      if (nodeOne.isLeaf() && nodeTwo.isLeaf())
+      {
+        if (boxesOverlap(nodeOne.tightLower, nodeOne.tightUpper, nodeTwo.tightLower, nodeTwo.tightUpper))
+          pairs.push_back({std::min(indexOne, indexTwo), std::max(indexOne, indexTwo)});
+      }
+      else if (nodeTwo.isLeaf() || (!nodeOne.isLeaf() && nodeOne.height >= nodeTwo.height))
+      {
+        stack.push_back({nodeOne.childOne, indexTwo});
+        stack.push_back({nodeOne.childTwo, indexTwo});
+      }
+      else
+      {
+        stack.push_back({indexOne, nodeTwo.childOne});
+        stack.push_back({indexOne, nodeTwo.childTwo});
+      }
+    }
+  }
+}
+
+void mk::Shapes::Collision::AABBTree::raycast(const mk::Space::Vec2& origin, const mk::Space::Vec2& end, std::vector<mk::Shapes::Collision::AABBTree::RaycastHit>& hits) const
+{
+  hits.clear();
+  if (root == NULL_PROXY)
+    return;
+
+  const mk::Space::Vec2 delta = end - origin;
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty())
+  {
+    const int index = stack.back();
+    const Node& node = nodes[index];
+    stack.pop_back();
+
+    float fraction;
+    if (!segmentFraction(node.lower, node.upper, origin, delta, 1.f, fraction))
+      continue;
+
+    if (node.isLeaf())
+    {
+      if (segmentFraction(node.tightLower, node.tightUpper, origin, delta, 1.f, fraction))
+        hits.push_back({index, fraction});
+    }
+    else
+    {
+      stack.push_back(node.childOne);
+      stack.push_back(node.childTwo);
+    }
+  }
+
+  std::sort(
+    hits.begin(),
+    hits.end(),
+    [](const RaycastHit& hitOne, const RaycastHit& hitTwo)
+    {
+      return hitOne.fraction < hitTwo.fraction;
+    }
+  );
+}
+
+bool mk::Shapes::Collision::AABBTree::raycastClosest(const mk::Space::Vec2& origin, const mk::Space::Vec2& end, mk::Shapes::Collision::AABBTree::RaycastHit& hit) const
+{
+  if (root == NULL_PROXY)
+    return false;
+
+  const mk::Space::Vec2 delta = end - origin;
+  float maxFraction {1.f};
+  bool found {false};
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty())
+  {
+    const int index = stack.back();
+    const Node& node = nodes[index];
+    stack.pop_back();
+
+    float fraction;
+    if (!segmentFraction(node.lower, node.upper, origin, delta, maxFraction, fraction))
+      continue;
+
+    if (node.isLeaf())
+    {
+      if (segmentFraction(node.tightLower, node.tightUpper, origin, delta, maxFraction, fraction))
+      {
+        hit = {index, fraction};
+        maxFraction = fraction;
+        found = true;
+      }
+    }
+    else
+    {
+      stack.push_back(node.childOne);
+      stack.push_back(node.childTwo);
+    }
+  }
+  return found;
+}
+
+bool mk::Shapes::Collision::AABBTree::sweep(const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& motion, mk::Shapes::Collision::SweepHit& hit, const int ignoredProxy) const
+{
+  if (root == NULL_PROXY)
+    return false;
+
+  const mk::Space::Vec2 lower {bounds.x, bounds.y};
+  const mk::Space::Vec2 upper {bounds.x + bounds.width, bounds.y + bounds.height};
+  // Every hit shortens the motion left to test, so farther subtrees are skipped
+  mk::Shapes::Collision::SweepHit closest;
+  bool found {false};
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(root);
+  while (!stack.empty())
+  {
+    const int index = stack.back();
+    const Node& node = nodes[index];
+    stack.pop_back();
+
+    mk::Shapes::Collision::SweepHit nodeHit;
+    if (!sweepBoxes(lower, upper, motion, node.lower, node.upper, closest.time, nodeHit))
+      continue;
+
+    if (node.isLeaf())
+    {
+      if (index != ignoredProxy && sweepBoxes(lower, upper, motion, node.tightLower, node.tightUpper, closest.time, nodeHit))
+      {
+        closest = nodeHit;
+        closest.proxy = index;
+        found = true;
+      }
+    }
+    else
+    {
+      stack.push_back(node.childOne);
+      stack.push_back(node.childTwo);
+    }
+  }
+  if (found)
+    hit = closest;
+  return found;
+}
+
+int mk::Shapes::Collision::AABBTree::_allocateNode()
+{
+  if (freeList == NULL_PROXY)
+  {
+    nodes.emplace_back();
+    return static_cast<int>(nodes.size()) - 1;
+  }
+
+  const int index = freeList;
+  freeList = nodes[index].parent;
+  nodes[index] = Node();
+  return index;
+}
+
+void mk::Shapes::Collision::AABBTree::_freeNode(const int index)
+{
+  nodes[index].parent = freeList;
+  nodes[index].height = -1;
+  freeList = index;
+}
+
+void mk::Shapes::Collision::AABBTree::_insertLeaf(const int leaf)
+{
+  if (root == NULL_PROXY)
+  {
+    root = leaf;
+    nodes[root].parent = NULL_PROXY;
+    return;
+  }
+
+  // Descend towards the sibling with the lowest cost, where the cost is the perimeter the insertion adds
+  const mk::Space::Vec2 leafLower = nodes[leaf].lower;
+  const mk::Space::Vec2 leafUpper = nodes[leaf].upper;
+  int index = root;
+  while (!nodes[index].isLeaf())
+  {
+    const Node& node = nodes[index];
+    const float perimeter = boxPerimeter(node.lower, node.upper);
+    const float combinedPerimeter = boxPerimeter(
+      {std::min(node.lower.x, leafLower.x), std::min(node.lower.y, leafLower.y)},
+      {std::max(node.upper.x, leafUpper.x), std::max(node.upper.y, leafUpper.y)}
+    );
+
+    // Cost of creating a new parent for this node and the new leaf
+    const float cost = 2.f * combinedPerimeter;
+    // Minimum cost of pushing the leaf further down the tree
+    const float inheritanceCost = 2.f * (combinedPerimeter - perimeter);
+
+    float childCosts[2];
+    const int children[2] {node.childOne, node.childTwo};
+    for (int i = 0; i < 2; i++)
+    {
+      const Node& child = nodes[children[i]];
+      const float childPerimeter = boxPerimeter(
+        {std::min(child.lower.x, leafLower.x), std::min(child.lower.y, leafLower.y)},
+        {std::max(child.upper.x, leafUpper.x), std::max(child.upper.y, leafUpper.y)}
+      );
+      childCosts[i] = child.isLeaf()
+        ? childPerimeter + inheritanceCost
+        : childPerimeter - boxPerimeter(child.lower, child.upper) + inheritanceCost;
+    }
+
+    if (cost < childCosts[0] && cost < childCosts[1])
+      break;
+    index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+  }
+  const int sibling = index;
+
+  // Create a new parent for the sibling and the leaf
+  const int oldParent = nodes[sibling].parent;
+  const int newParent = _allocateNode();
+  Node& parent = nodes[newParent];
+  parent.parent = oldParent;
+  parent.lower = {std::min(nodes[sibling].lower.x, leafLower.x), std::min(nodes[sibling].lower.y, leafLower.y)};
+  parent.upper = {std::max(nodes[sibling].upper.x, leafUpper.x), std::max(nodes[sibling].upper.y, leafUpper.y)};
+  parent.height = nodes[sibling].height + 1;
+  parent.childOne = sibling;
+  parent.childTwo = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  if (oldParent == NULL_PROXY)
+    root = newParent;
+  else if (nodes[oldParent].childOne == sibling)
+    nodes[oldParent].childOne = newParent;
+  else
+    nodes[oldParent].childTwo = newParent;
+
+  _refit(newParent);
+}
+
+void mk::Shapes::Collision::AABBTree::_removeLeaf(const int leaf)
+{
+  if (leaf == root)
+  {
+    root = NULL_PROXY;
+    return;
+  }
+
+  const int parent = nodes[leaf].parent;
+  const int grandParent = nodes[parent].parent;
+  const int sibling = nodes[parent].childOne == leaf ? nodes[parent].childTwo : nodes[parent].childOne;
+
+  nodes[sibling].parent = grandParent;
+  _freeNode(parent);
+  if (grandParent == NULL_PROXY)
+  {
+    root = sibling;
+    return;
+  }
+
+  if (nodes[grandParent].childOne == parent)
+    nodes[grandParent].childOne = sibling;
+  else
+    nodes[grandParent].childTwo = sibling;
+  _refit(grandParent);
+}
+
+void mk::Shapes::Collision::AABBTree::_refit(int index)
+{
+  while (index != NULL_PROXY)
+  {
+    index = _balance(index);
+
+    Node& node = nodes[index];
+    const Node& childOne = nodes[node.childOne];
+    const Node& childTwo = nodes[node.childTwo];
+    node.height = 1 + std::max(childOne.height, childTwo.height);
+    node.lower = {std::min(childOne.lower.x, childTwo.lower.x), std::min(childOne.lower.y, childTwo.lower.y)};
+    node.upper = {std::max(childOne.upper.x, childTwo.upper.x), std::max(childOne.upper.y, childTwo.upper.y)};
+
+    index = node.parent;
+  }
+}
+
+int mk::Shapes::Collision::AABBTree::_balance(const int index)
+{
+  Node& a = nodes[index];
+  if (a.isLeaf() || a.height < 2)
+    return index;
+
+  const int indexB = a.childOne;
+  const int indexC = a.childTwo;
+  Node& b = nodes[indexB];
+  Node& c = nodes[indexC];
+  const int balance = c.height - b.height;
+
+  // Rotates the taller child up into the place of the node, and the node down into the place of the
+  // taller child's shorter child
+  const auto rotate = [this, index, &a](const int indexUp, Node& up, Node& other, const bool upIsChildTwo)
+  {
+    const int indexF = up.childOne;
+    const int indexG = up.childTwo;
+    Node& f = nodes[indexF];
+    Node& g = nodes[indexG];
+
+    up.childOne = index;
+    up.parent = a.parent;
+    a.parent = indexUp;
+    if (up.parent == NULL_PROXY)
+      root = indexUp;
+    else if (nodes[up.parent].childOne == index)
+      nodes[up.parent].childOne = indexUp;
+    else
+      nodes[up.parent].childTwo = indexUp;
+
+    // The taller grandchild stays under the rotated child, and the shorter one moves under the node
+    const bool keepF = f.height > g.height;
+    const int indexKept = keepF ? indexF : indexG;
+    const int indexMoved = keepF ? indexG : indexF;
+    Node& kept = keepF ? f : g;
+    Node& moved = keepF ? g : f;
+
+    up.childTwo = indexKept;
+    if (upIsChildTwo)
+      a.childTwo = indexMoved;
+    else
+      a.childOne = indexMoved;
+    moved.parent = index;
+
+    a.lower = {std::min(other.lower.x, moved.lower.x), std::min(other.lower.y, moved.lower.y)};
+    a.upper = {std::max(other.upper.x, moved.upper.x), std::max(other.upper.y, moved.upper.y)};
+    up.lower = {std::min(a.lower.x, kept.lower.x), std::min(a.lower.y, kept.lower.y)};
+    up.upper = {std::max(a.upper.x, kept.upper.x), std::max(a.upper.y, kept.upper.y)};
+    a.height = 1 + std::max(other.height, moved.height);
+    up.height = 1 + std::max(a.height, kept.height);
+    return indexUp;
+  };
+
+  if (balance > 1)
+    return rotate(indexC, c, b, true);
+  if (balance < -1)
+    return rotate(indexB, b, c, false);
+  return index;
+}
+
+std::uint64_t cellKey(const int x, const int y)
+{
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+// Fibonacci hashing spreads neighbouring cells across the table, which has a power of two size
+std::size_t cellHash(const std::uint64_t key, const std::size_t mask)
+{
+  return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+int mk::Shapes::Collision::SpatialHash::insert(const mk::Shapes::BoundRect& bounds, void* userData)
+{
+  Proxy proxy;
+  proxy.lower = {bounds.x, bounds.y};
+  proxy.upper = {bounds.x + bounds.width, bounds.y + bounds.height};
+  proxy.userData = userData;
+  proxy.cellMinX = _cellCoordinate(proxy.lower.x);
+  proxy.cellMinY = _cellCoordinate(proxy.lower.y);
+  proxy.cellMaxX = _cellCoordinate(proxy.upper.x);
+  proxy.cellMaxY = _cellCoordinate(proxy.upper.y);
+  proxies.push_back(proxy);
+
+  coveredCells += static_cast<std::size_t>(proxy.cellMaxX - proxy.cellMinX + 1) * static_cast<std::size_t>(proxy.cellMaxY - proxy.cellMinY + 1);
+  isBuilt = false;
+  return static_cast<int>(proxies.size()) - 1;
+}
+
+void mk::Shapes::Collision::SpatialHash::clear()
+{
+  proxies.clear();
+  cellProxies.clear();
+  occupiedSlots.clear();
+  coveredCells = 0u;
+  isBuilt = true;
+}
+
+void mk::Shapes::Collision::SpatialHash::query(const mk::Shapes::BoundRect& region, std::vector<int>& proxies)
+{
+  proxies.clear();
+  _build();
+  if (occupiedSlots.empty())
+    return;
+
+  const mk::Space::Vec2 lower {region.x, region.y};
+  const mk::Space::Vec2 upper {region.x + region.width, region.y + region.height};
+  const int minX = _cellCoordinate(lower.x);
+  const int minY = _cellCoordinate(lower.y);
+  const int maxX = _cellCoordinate(upper.x);
+  const int maxY = _cellCoordinate(upper.y);
+  for (int x = minX; x <= maxX; x++)
+  {
+    for (int y = minY; y <= maxY; y++)
+    {
+      const int index = _findSlot(cellKey(x, y));
+      if (index < 0)
+        continue;
+
+      const Slot& slot = table[index];
+      for (int i = slot.offset; i < slot.offset + slot.count; i++)
+      {
+        const int proxy = cellProxies[i];
+        const Proxy& entry = this->proxies[proxy];
+        // A proxy is reported only from the cell holding the lower corner of its overlap with the region
+        if (std::max(minX, entry.cellMinX) == x && std::max(minY, entry.cellMinY) == y && boxesOverlap(entry.lower, entry.upper, lower, upper))
+          proxies.push_back(proxy);
+      }
+    }
+  }
+}
+
+void mk::Shapes::Collision::SpatialHash::queryPairs(std::vector<mk::Shapes::Collision::Pair>& pairs)
+{
+  pairs.clear();
+  _build();
+
+  for (const int index : occupiedSlots)
+  {
+    const Slot& slot = table[index];
+    const int x = static_cast<int>(static_cast<std::uint32_t>(slot.key >> 32));
+    const int y = static_cast<int>(static_cast<std::uint32_t>(slot.key));
+    const int end = slot.offset + slot.count;
+    for (int i = slot.offset; i < end; i++)
+    {
+      const Proxy& one = proxies[cellProxies[i]];
+      for (int j = i + 1; j < end; j++)
+      {
+        const Proxy& two = proxies[cellProxies[j]];
+        // Proxies sharing several cells are reported only from the cell holding the lower corner of their overlap
+        if (std::max(one.cellMinX, two.cellMinX) != x || std::max(one.cellMinY, two.cellMinY) != y)
+          continue;
+        if (boxesOverlap(one.lower, one.upper, two.lower, two.upper))
+          pairs.push_back({std::min(cellProxies[i], cellProxies[j]), std::max(cellProxies[i], cellProxies[j])});
+      }
+    }
+  }
+}
+
+bool mk::Shapes::Collision::SpatialHash::sweep(const mk::Shapes::BoundRect& bounds, const mk::Space::Vec2& motion, mk::Shapes::Collision::SweepHit& hit, const int ignoredProxy)
+{
+  query(mk::Shapes::Collision::sweptBounds(bounds, motion), sweepCandidates);
+
+  const mk::Space::Vec2 lower {bounds.x, bounds.y};
+  const mk::Space::Vec2 upper {bounds.x + bounds.width, bounds.y + bounds.height};
+  mk::Shapes::Collision::SweepHit closest;
+  bool found {false};
+  for (const int proxy : sweepCandidates)
+  {
+    mk::Shapes::Collision::SweepHit candidateHit;
+    const Proxy& entry = proxies[proxy];
+    if (proxy != ignoredProxy && sweepBoxes(lower, upper, motion, entry.lower, entry.upper, closest.time, candidateHit))
+    {
+      closest = candidateHit;
+      closest.proxy = proxy;
+      found = true;
+    }
+  }
+  if (found)
+    hit = closest;
+  return found;
+}
+
+int mk::Shapes::Collision::SpatialHash::_cellCoordinate(const float value) const
+{
+  return static_cast<int>(std::floor(value * inverseCellSize));
+}
+
+int mk::Shapes::Collision::SpatialHash::_findSlot(const std::uint64_t key) const
+{
+  const std::size_t mask = table.size() - 1;
+  for (std::size_t index = cellHash(key, mask); ; index = (index + 1) & mask)
+  {
+    const Slot& slot = table[index];
+    if (slot.stamp != stamp)
+      return -1;
+    if (slot.key == key)
+      return static_cast<int>(index);
+  }
+}
+
+int mk::Shapes::Collision::SpatialHash::_findOrAddSlot(const std::uint64_t key)
+{
+  const std::size_t mask = table.size() - 1;
+  for (std::size_t index = cellHash(key, mask); ; index = (index + 1) & mask)
+  {
+    Slot& slot = table[index];
+    if (slot.stamp != stamp)
+    {
+      slot.key = key;
+      slot.stamp = stamp;
+      slot.count = 0;
+      occupiedSlots.push_back(static_cast<int>(index));
+      return static_cast<int>(index);
+    }
+    if (slot.key == key)
+      return static_cast<int>(index);
+  }
+}
+
+void mk::Shapes::Collision::SpatialHash::_build()
+{
+  if (isBuilt)
+    return;
+  isBuilt = true;
+
+  // Bumping the stamp empties every slot without touching the table, which is grown to stay at most half full
+  occupiedSlots.clear();
+  stamp++;
+  std::size_t capacity {16u};
+  while (capacity < coveredCells * 2u)
+    capacity *= 2u;
+  if (table.size() < capacity || stamp == 0u)
+  {
+    table.assign(std::max(capacity, table.size()), Slot());
+    stamp = 1u;
+  }
+
+  // Count the proxies of every cell
+  for (const Proxy& proxy : proxies)
+    for (int x = proxy.cellMinX; x <= proxy.cellMaxX; x++)
+      for (int y = proxy.cellMinY; y <= proxy.cellMaxY; y++)
+        table[_findOrAddSlot(cellKey(x, y))].count++;
+
+  // Give every cell a contiguous range of cellProxies
+  int offset {0};
+  for (const int index : occupiedSlots)
+  {
+    Slot& slot = table[index];
+    slot.offset = offset;
+    offset += slot.count;
+    slot.count = 0;
+  }
+  cellProxies.resize(static_cast<std::size_t>(offset));
+
+  // Fill the ranges
+  for (std::size_t proxy = 0; proxy < proxies.size(); proxy++)
+  {
+    const Proxy& entry = proxies[proxy];
+    for (int x = entry.cellMinX; x <= entry.cellMaxX; x++)
+    {
+      for (int y = entry.cellMinY; y <= entry.cellMaxY; y++)
+      {
+        Slot& slot = table[_findSlot(cellKey(x, y))];
+        cellProxies[slot.offset + slot.count++] = static_cast<int>(proxy);
+      }
+    }
+  }
+}
+
+// Endpoints are ordered by value, with interval ends before starts so that touching intervals never meet in the sweep
+bool endpointPrecedes(const float valueOne, const bool isMinOne, const float valueTwo, const bool isMinTwo)
+{
+  return valueOne < valueTwo || (valueOne == valueTwo && !isMinOne && isMinTwo);
+}
+
+bool pairPrecedes(const mk::Shapes::Collision::Pair& pairOne, const mk::Shapes::Collision::Pair& pairTwo)
+{
+  return pairOne.proxyOne < pairTwo.proxyOne || (pairOne.proxyOne == pairTwo.proxyOne && pairOne.proxyTwo < pairTwo.proxyTwo);
+}
+
+int mk::Shapes::Collision::SweepAndPrune::insert(const mk::Shapes::BoundRect& bounds, void* userData)
+{
+  int proxy;
+  if (freeProxies.empty())
+  {
+    proxy = static_cast<int>(proxies.size());
+    proxies.emplace_back();
+  }
+  else
+  {
+    proxy = freeProxies.back();
+    freeProxies.pop_back();
+  }
+
+  Proxy& entry = proxies[proxy];
+  entry.lower = {bounds.x, bounds.y};
+  entry.upper = {bounds.x + bounds.width, bounds.y + bounds.height};
+  entry.userData = userData;
+  entry.activeIndex = -1;
+
+  // The stored endpoint values are still sorted, so the new endpoints can be placed directly
+  for (const bool isMin : {true, false})
+  {
+    const Endpoint endpoint {isMin ? entry.lower.x : entry.upper.x, proxy, isMin};
+    const auto position = std::upper_bound(endpoints.begin(), endpoints.end(), endpoint,
+      [](const Endpoint& one, const Endpoint& two) { return endpointPrecedes(one.value, one.isMin, two.value, two.isMin); });
+    endpoints.insert(position, endpoint);
+  }
+  proxyCount++;
+  return proxy;
+}
+
+void mk::Shapes::Collision::SweepAndPrune::remove(const int proxy)
+{
+  endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [proxy](const Endpoint& endpoint) { return endpoint.proxy == proxy; }), endpoints.end());
+  removedProxies.push_back(proxy);
+  proxyCount--;
+}
+
+void mk::Shapes::Collision::SweepAndPrune::move(const int proxy, const mk::Shapes::BoundRect& bounds)
+{
+  Proxy& entry = proxies[proxy];
+  entry.lower = {bounds.x, bounds.y};
+  entry.upper = {bounds.x + bounds.width, bounds.y + bounds.height};
+}
+
+void mk::Shapes::Collision::SweepAndPrune::clear()
+{
+  proxies.clear();
+  endpoints.clear();
+  pairs.clear();
+  freeProxies.clear();
+  removedProxies.clear();
+  swapCount = 0u;
+  proxyCount = 0;
+}
+
+void mk::Shapes::Collision::SweepAndPrune::update(std::vector<mk::Shapes::Collision::Pair>& begun, std::vector<mk::Shapes::Collision::Pair>& ended)
+{
+  begun.clear();
+  ended.clear();
+  _sortEndpoints();
+  _sweep();
+
+  // Both pair lists are sorted, so a single merge finds the pairs present in only one of them
+  std::size_t oldIndex {0u};
+  std::size_t newIndex {0u};
+  while (oldIndex < pairs.size() || newIndex < nextPairs.size())
+  {
+    if (newIndex == nextPairs.size() || (oldIndex < pairs.size() && pairPrecedes(pairs[oldIndex], nextPairs[newIndex])))
+      ended.push_back(pairs[oldIndex++]);
+    else if (oldIndex == pairs.size() || pairPrecedes(nextPairs[newIndex], pairs[oldIndex]))
+      begun.push_back(nextPairs[newIndex++]);
+    else
+    {
+      oldIndex++;
+      newIndex++;
+    }
+  }
+  pairs.swap(nextPairs);
+
+  // The ends of the pairs of removed proxies were just reported, so their IDs can be reused
+  freeProxies.insert(freeProxies.end(), removedProxies.begin(), removedProxies.end());
+  removedProxies.clear();
+}
+
+void mk::Shapes::Collision::SweepAndPrune::_sortEndpoints()
+{
+  for (Endpoint& endpoint : endpoints)
+  {
+    const Proxy& proxy = proxies[endpoint.proxy];
+    endpoint.value = endpoint.isMin ? proxy.lower.x : proxy.upper.x;
+  }
+
+  swapCount = 0u;
+  for (std::size_t i = 1; i < endpoints.size(); i++)
+  {
+    const Endpoint endpoint = endpoints[i];
+    std::size_t j = i;
+    while (j > 0 && endpointPrecedes(endpoint.value, endpoint.isMin, endpoints[j - 1].value, endpoints[j - 1].isMin))
+    {
+      endpoints[j] = endpoints[j - 1];
+      j--;
+    }
+    swapCount += i - j;
+    endpoints[j] = endpoint;
+  }
+}
+
+void mk::Shapes::Collision::SweepAndPrune::_sweep()
+{
+  nextPairs.clear();
+  active.clear();
+  for (const Endpoint& endpoint : endpoints)
+  {
+    Proxy& proxy = proxies[endpoint.proxy];
+    if (endpoint.isMin)
+    {
+      // Every open interval overlaps this one on the x axis, so only the full test is left
+      for (const int other : active)
+      {
+        const Proxy& otherProxy = proxies[other];
+        if (boxesOverlap(proxy.lower, proxy.upper, otherProxy.lower, otherProxy.upper))
+          nextPairs.push_back({std::min(endpoint.proxy, other), std::max(endpoint.proxy, other)});
+      }
+      // Empty intervals cannot overlap intervals starting after them
+      if (proxy.upper.x > proxy.lower.x)
+      {
+        proxy.activeIndex = static_cast<int>(active.size());
+        active.push_back(endpoint.proxy);
+      }
+    }
+    else if (proxy.activeIndex >= 0)
+    {
+      const int last = active.back();
+      active[proxy.activeIndex] = last;
+      proxies[last].activeIndex = proxy.activeIndex;
+      active.pop_back();
+      proxy.activeIndex = -1;
+    }
+  }
+  std::sort(nextPairs.begin(), nextPairs.end(), pairPrecedes);
+}
+
+// Tests rectangles [first, first + count) of a batch, returning their hit bits starting from bit zero
+std::uint8_t boundHitBits(const mk::Shapes::BoundRect& rect, const mk::Shapes::Collision::BoundArrays& rects, const std::size_t first, const std::size_t count)
+{
+  std::uint8_t bits {0u};
+  for (std::size_t i = 0; i < count; i++)
+  {
+    const std::size_t index = first + i;
+    const bool hit =
+      rect.x < rects.x[index] + rects.width[index] &&
+      rect.x + rect.width > rects.x[index] &&
+      rect.y < rects.y[index] + rects.height[index] &&
+      rect.y + rect.height > rects.y[index];
+    bits |= static_cast<std::uint8_t>(hit) << i;
+  }
+  return bits;
+}
+
+std::size_t mk::Shapes::Collision::Scalar::AABB(const mk::Shapes::BoundRect& rect, const mk::Shapes::Collision::BoundArrays& rects, std::uint8_t* hits)
+{
+  std::size_t hitCount {0u};
+  for (std::size_t first = 0; first < rects.count; first += 8)
+  {
+    const std::uint8_t bits = boundHitBits(rect, rects, first, std::min<std::size_t>(8u, rects.count - first));
+    hits[first / 8] = bits;
+    hitCount += std::bitset<8>(bits).count();
+  }
+  return hitCount;
+}
+
+std::size_t mk::Shapes::Collision::AABB(const mk::Shapes::BoundRect& rect, const mk::Shapes::Collision::BoundArrays& rects, std::uint8_t* hits)
+{
+#if defined(MK_SIMD_SSE)
+  const std::size_t vectorCount = rects.count & ~static_cast<std::size_t>(7);
+  std::size_t hitCount {0u};
+
+  // Each lane checks rect.x < x + width, rect.right > x, rect.y < y + height and rect.bottom > y
+  #if defined(MK_SIMD_AVX)
+  const __m256 left = _mm256_set1_ps(rect.x);
+  const __m256 right = _mm256_set1_ps(rect.x + rect.width);
+  const __m256 top = _mm256_set1_ps(rect.y);
+  const __m256 bottom = _mm256_set1_ps(rect.y + rect.height);
+  for (std::size_t i = 0; i < vectorCount; i += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(rects.x + i);
+    const __m256 y = _mm256_loadu_ps(rects.y + i);
+    const __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(left, _mm256_add_ps(x, _mm256_loadu_ps(rects.width + i)), _CMP_LT_OQ), _mm256_cmp_ps(right, x, _CMP_GT_OQ));
+    const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(top, _mm256_add_ps(y, _mm256_loadu_ps(rects.height + i)), _CMP_LT_OQ), _mm256_cmp_ps(bottom, y, _CMP_GT_OQ));
+    const std::uint8_t bits = static_cast<std::uint8_t>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY)));
+    hits[i / 8] = bits;
+    hitCount += std::bitset<8>(bits).count();
+  }
+  #else
+  const __m128 left = _mm_set1_ps(rect.x);
+  const __m128 right = _mm_set1_ps(rect.x + rect.width);
+  const __m128 top = _mm_set1_ps(rect.y);
+  const __m128 bottom = _mm_set1_ps(rect.y + rect.height);
+  const auto hitMask = [&](const std::size_t i)
+  {
+    const __m128 x = _mm_loadu_ps(rects.x + i);
+    const __m128 y = _mm_loadu_ps(rects.y + i);
+    const __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(left, _mm_add_ps(x, _mm_loadu_ps(rects.width + i))), _mm_cmpgt_ps(right, x));
+    const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(top, _mm_add_ps(y, _mm_loadu_ps(rects.height + i))), _mm_cmpgt_ps(bottom, y));
+    return _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+  };
+  for (std::size_t i = 0; i < vectorCount; i += 8)
+  {
+    const std::uint8_t bits = static_cast<std::uint8_t>(hitMask(i) | (hitMask(i + 4) << 4));
+    hits[i / 8] = bits;
+    hitCount += std::bitset<8>(bits).count();
+  }
+  #endif
+
+  if (vectorCount < rects.count)
+  {
+    const std::uint8_t bits = boundHitBits(rect, rects, vectorCount, rects.count - vectorCount);
+    hits[vectorCount / 8] = bits;
+    hitCount += std::bitset<8>(bits).count();
+  }
+  return hitCount;
+#else
+  return mk::Shapes::Collision::Scalar::AABB(rect, rects, hits);
+#endif
+}
+
+// Half the width of a box projected on an axis
+float projectedRadius(const mk::Shapes::OrientedBox& box, const mk::Space::Vec2& axis)
+{
+  return
+    box.halfExtents.x * std::abs(mk::Space::dot(box.axes[0], axis)) +
+    box.halfExtents.y * std::abs(mk::Space::dot(box.axes[1], axis));
+}
+
+// Largest distance from an edge of polygonOne to the deepest vertex of polygonTwo, which is positive if the edge separates them
+float maxSeparation(const mk::Shapes::ConvexPolygon& polygonOne, const mk::Shapes::ConvexPolygon& polygonTwo, int& edge)
+{
+  float maxDistance {std::numeric_limits<float>::lowest()};
+  for (int i = 0; i < polygonOne.getCount(); i++)
+  {
+    const mk::Space::Vec2& normal = polygonOne.getNormal(i);
+    const mk::Space::Vec2& vertex = polygonOne.getVertex(i);
+    float distance {std::numeric_limits<float>::max()};
+    for (int j = 0; j < polygonTwo.getCount(); j++)
+      distance = std::min(distance, mk::Space::dot(normal, polygonTwo.getVertex(j) - vertex));
+    if (distance > maxDistance)
+    {
+      maxDistance = distance;
+      edge = i;
+    }
+  }
+  return maxDistance;
+}
+
+// Clips a segment to the side of the line dot(direction, point) = offset where dot(direction, point) <= offset
+int clipSegment(const mk::Space::Vec2 (&input)[2], mk::Space::Vec2 (&output)[2], const mk::Space::Vec2& direction, const float offset)
+{
+  const float distanceOne = mk::Space::dot(direction, input[0]) - offset;
+  const float distanceTwo = mk::Space::dot(direction, input[1]) - offset;
+
+  int count {0};
+  if (distanceOne <= 0.f)
+    output[count++] = input[0];
+  if (distanceTwo <= 0.f)
+    output[count++] = input[1];
+  if (distanceOne * distanceTwo < 0.f)
+    output[count++] = input[0] + (input[1] - input[0]) * (distanceOne / (distanceOne - distanceTwo));
+  return count;
+}
+
+bool mk::Shapes::Collision::OBB(const mk::Shapes::OrientedBox& boxOne, const mk::Shapes::OrientedBox& boxTwo)
+{
+  const mk::Space::Vec2 offset = boxTwo.center - boxOne.center;
+  for (const mk::Space::Vec2& axis : {boxOne.axes[0], boxOne.axes[1], boxTwo.axes[0], boxTwo.axes[1]})
+    if (std::abs(mk::Space::dot(offset, axis)) >= projectedRadius(boxOne, axis) + projectedRadius(boxTwo, axis))
+      return false;
+  return true;
+}
+
+bool mk::Shapes::Collision::SAT(const mk::Shapes::ConvexPolygon& polygonOne, const mk::Shapes::ConvexPolygon& polygonTwo, mk::Shapes::Collision::Manifold& manifold)
+{
+  int edgeOne {0};
+  const float separationOne = maxSeparation(polygonOne, polygonTwo, edgeOne);
+  if (separationOne >= 0.f)
+    return false;
+  int edgeTwo {0};
+  const float separationTwo = maxSeparation(polygonTwo, polygonOne, edgeTwo);
+  if (separationTwo >= 0.f)
+    return false;
+
+  // The first polygon is preferred as the reference, so nearly equal separations do not make the manifold flicker
+  const bool isFlipped = separationTwo > separationOne + 0.0005f * std::max(1.f, std::abs(separationOne));
+  const mk::Shapes::ConvexPolygon& reference = isFlipped ? polygonTwo : polygonOne;
+  const mk::Shapes::ConvexPolygon& incident = isFlipped ? polygonOne : polygonTwo;
+  const int referenceEdge = isFlipped ? edgeTwo : edgeOne;
+  const mk::Space::Vec2 normal = reference.getNormal(referenceEdge);
+
+  // The incident edge is the one facing the reference face the most
+  int incidentEdge {0};
+  float minDot {std::numeric_limits<float>::max()};
+  for (int i = 0; i < incident.getCount(); i++)
+  {
+    const float normalDot = mk::Space::dot(normal, incident.getNormal(i));
+    if (normalDot < minDot)
+    {
+      minDot = normalDot;
+      incidentEdge = i;
+    }
+  }
+
+  const mk::Space::Vec2 segment[2] {incident.getVertex(incidentEdge), incident.getVertex((incidentEdge + 1) % incident.getCount())};
+  const mk::Space::Vec2& referenceOne = reference.getVertex(referenceEdge);
+  const mk::Space::Vec2& referenceTwo = reference.getVertex((referenceEdge + 1) % reference.getCount());
+  const mk::Space::Vec2 tangent = mk::Space::normalize(referenceTwo - referenceOne);
+
+  // Clip the incident edge to the side planes of the reference face
+  mk::Space::Vec2 clippedOnce[2];
+  if (clipSegment(segment, clippedOnce, -tangent, -mk::Space::dot(tangent, referenceOne)) < 2)
+    return false;
+  mk::Space::Vec2 clippedTwice[2];
+  if (clipSegment(clippedOnce, clippedTwice, tangent, mk::Space::dot(tangent, referenceTwo)) < 2)
+    return false;
+
+  // Keep the points behind the reference face
+  mk::Shapes::Collision::Manifold contact;
+  const float faceOffset = mk::Space::dot(normal, referenceOne);
+  for (const mk::Space::Vec2& point : clippedTwice)
+  {
+    const float separation = mk::Space::dot(normal, point) - faceOffset;
+    if (separation <= 0.f)
+      contact.points[contact.pointCount++] = point - normal * (separation / 2.f);
+  }
+  if (contact.pointCount == 0)
+    return false;
+
+  contact.normal = isFlipped ? -normal : normal;
+  contact.depth = -(isFlipped ? separationTwo : separationOne);
+  manifold = contact;
+  return true;
+}
+
+bool mk::Shapes::Collision::SAT(const mk::Shapes::OrientedBox& boxOne, const mk::Shapes::OrientedBox& boxTwo, mk::Shapes::Collision::Manifold& manifold)
+{
+  if (!OBB(boxOne, boxTwo))
+    return false;
+  return SAT(mk::Shapes::ConvexPolygon(boxOne), mk::Shapes::ConvexPolygon(boxTwo), manifold);
 }